@@ -1,76 +1,224 @@
 #include "BaseObject.h"
+#include <algorithm>
+#include <unordered_set>
+#include "TextureResidency.h"
 
-std::list< BaseObject* > BaseObject::ourObjects;
-std::list< BaseObject* > BaseObject::ourStartQueue;
+std::unordered_map< int, BaseObject::StageBuckets > BaseObject::ourObjects;
+std::vector< BaseObject* > BaseObject::ourStartQueue;
+unsigned BaseObject::ourNextOrder = 0;
+unsigned BaseObject::ourFrame = 1;
+int BaseObject::ourCulledCount = 0;
+int BaseObject::ourLastCulledCount = 0;
+int BaseObject::ourLastRoom = -1;
 
 
-void BaseObject::UpdateAll()
+void BaseObject::AddToBucket( BaseObject* obj )
+{
+    Bucket& bucket = ourObjects[obj->myRoom][obj->myRenderStage];
+    auto& slots = bucket.slots;
+
+    // Newly created objects always go last; moved ones are inserted by their order
+    // and shift the indexes of the following slots
+    auto i = slots.end();
+    if ( !slots.empty() && slots.back().order > obj->myOrder )
+    {
+        i = std::upper_bound( slots.begin(), slots.end(), obj->myOrder,
+            []( unsigned order, Slot const& slot ) { return order < slot.order; } );
+    }
+
+    size_t index = i - slots.begin();
+    slots.insert( i, Slot{ obj->myOrder, obj } );
+    for ( size_t n = index; n < slots.size(); ++n )
+    {
+        if ( slots[n].obj )
+        {
+            slots[n].obj->myBucketIndex = n;
+        }
+    }
+}
+
+void BaseObject::RemoveFromBucket( BaseObject* obj )
 {
+    Bucket& bucket = ourObjects[obj->myRoom][obj->myRenderStage];
+    if ( obj->myBucketIndex >= bucket.slots.size() || bucket.slots[obj->myBucketIndex].obj != obj )
+    {
+        return;
+    }
+
+    bucket.slots[obj->myBucketIndex].obj = nullptr;
+    if ( ++bucket.holes * 2 > bucket.slots.size() )
+    {
+        CompactBucket( bucket );
+    }
+}
+
+void BaseObject::CompactBucket( Bucket& bucket )
+{
+    auto& slots = bucket.slots;
+    size_t count = 0;
+    for ( size_t n = 0; n < slots.size(); ++n )
+    {
+        if ( slots[n].obj )
+        {
+            slots[count] = slots[n];
+            slots[count].obj->myBucketIndex = count;
+            ++count;
+        }
+    }
+    slots.resize( count );
+    bucket.holes = 0;
+}
+
+// Visits objects of the given stage which belong either to the given room
+// or to no room at all, merging both buckets in the creation order.
+template <typename TFunc>
+void BaseObject::ForEachInStage( int room, RenderStage stage, TFunc func )
+{
+    static std::vector< Slot > const empty;
+    auto anyRoom = ourObjects.find( -1 );
+    auto thisRoom = ourObjects.find( room );
+    auto const& a = anyRoom != ourObjects.end() ? anyRoom->second[stage].slots : empty;
+    auto const& b = thisRoom != ourObjects.end() && room != -1 ? thisRoom->second[stage].slots : empty;
+
+    auto i = a.begin();
+    auto j = b.begin();
+    while ( i != a.end() || j != b.end() )
+    {
+        Slot const& slot = ( j == b.end() || ( i != a.end() && i->order < j->order ) ) ? *i++ : *j++;
+        if ( slot.obj )
+        {
+            func( slot.obj );
+        }
+    }
+}
+
+void BaseObject::EvictOtherRooms( int room )
+{
+    // Render objects may be shared with the objects of this room
+    std::unordered_set< RenderObject* > used;
+    for ( int stage = 0; stage < NUM_RENDER_STAGES; ++stage )
+    {
+        ForEachInStage( room, (RenderStage)stage, [&used]( BaseObject* obj )
+        {
+            if ( obj->myRender )
+            {
+                used.insert( obj->myRender.get() );
+            }
+        });
+    }
+
     for ( auto i = ourObjects.begin(); i != ourObjects.end(); ++i )
     {
-        if ( (*i)->myIsEnabled && (*i)->myIsAutoUpdated && (*i)->myHasStarted )
+        if ( i->first == -1 || i->first == room )
         {
-            if ( (*i)->myRoom < 0 || (*i)->myRoom == GetAGS()->GetCurrentRoom() )
+            continue;
+        }
+        for ( auto const& bucket : i->second )
+        {
+            for ( auto const& slot : bucket.slots )
             {
-                (*i)->Update();
+                if ( !slot.obj || !slot.obj->myRender || used.count( slot.obj->myRender.get() ) )
+                {
+                    continue;
+                }
+                // Background taken in another room could not be read back in this one
+                int sourceRoom = slot.obj->myRender->GetSourceRoom();
+                if ( sourceRoom < 0 || sourceRoom == i->first )
+                {
+                    TextureResidency::Evict( slot.obj->myRender.get() );
+                }
             }
         }
     }
 }
 
-void BaseObject::RenderAll( RenderStage stage )
+void BaseObject::UpdateAll()
 {
-    // Run start calls
-    for ( auto i = ourStartQueue.begin(); i != ourStartQueue.end(); )
-    {
-        auto next = i;
-        ++next;
+    ++ourFrame;
+    ourLastCulledCount = ourCulledCount;
+    ourCulledCount = 0;
 
-        (*i)->Start();
-        (*i)->myHasStarted = true;
-        ourStartQueue.erase( i );
+    int room = GetAGS()->GetCurrentRoom();
+    if ( room != ourLastRoom )
+    {
+        EvictOtherRooms( room );
+        ourLastRoom = room;
+    }
+    TextureResidency::Trim();
 
-        i = next;
+    for ( int stage = 0; stage < NUM_RENDER_STAGES; ++stage )
+    {
+        ForEachInStage( room, (RenderStage)stage, []( BaseObject* obj )
+        {
+            if ( obj->myIsEnabled && !obj->myIsBranchDisabled && obj->myIsAutoUpdated && obj->myHasStarted )
+            {
+                obj->Update();
+            }
+        });
     }
+}
 
-    // Render
-    for ( auto i = ourObjects.begin(); i != ourObjects.end(); ++i )
+void BaseObject::RenderAll( RenderStage stage )
+{
+    // Run start calls
+    std::vector< BaseObject* > startQueue;
+    startQueue.swap( ourStartQueue );
+    for ( auto i = startQueue.begin(); i != startQueue.end(); ++i )
     {
-        if ( (*i)->myIsVisible && (*i)->myIsAutoRendered && (*i)->myRenderStage == stage )
+        if ( *i )
         {
-            if ( (*i)->myRoom < 0 || (*i)->myRoom == GetAGS()->GetCurrentRoom() )
+            if ( (*i)->myRestoredParentKey >= 0 )
             {
-                (*i)->Render();
+                (*i)->SetParent( (BaseObject*)GetAGS()->GetManagedObjectAddressByKey( (*i)->myRestoredParentKey ) );
+                (*i)->myRestoredParentKey = -1;
             }
+            (*i)->myStartIndex = NO_INDEX;
+            (*i)->Start();
+            (*i)->myHasStarted = true;
         }
     }
+
+    // Render
+    ForEachInStage( GetAGS()->GetCurrentRoom(), stage, []( BaseObject* obj )
+    {
+        if ( obj->myIsVisible && !obj->myIsBranchHidden && obj->myIsAutoRendered )
+        {
+            obj->Render();
+        }
+    });
+}
+
+int BaseObject::GetCulledCount()
+{
+    return ourLastCulledCount;
 }
 
 BaseObject::BaseObject()
 {
     DBG( "BaseObject created" );
-    ourObjects.push_back( this );
+    myOrder = ourNextOrder++;
+    AddToBucket( this );
+    myStartIndex = ourStartQueue.size();
     ourStartQueue.push_back( this );
 }
 
 BaseObject::~BaseObject()
 {
-    for ( auto i = ourObjects.begin(); i != ourObjects.end(); ++i )
+    // Detach from the parent and let the children go
+    SetParent( nullptr );
+    for ( auto i = myChildren.begin(); i != myChildren.end(); ++i )
     {
-        if ( *i == this )
-        {
-            ourObjects.erase( i );
-            break;
-        }
+        (*i)->myParent = nullptr;
+        (*i)->SetDirty();
+        (*i)->UpdateBranchState();
     }
+    myChildren.clear();
 
-	for ( auto i = ourStartQueue.begin(); i != ourStartQueue.end(); ++i )
+    RemoveFromBucket( this );
+
+    if ( myStartIndex != NO_INDEX )
     {
-        if ( *i == this )
-        {
-            ourStartQueue.erase( i );
-            break;
-        }
+        ourStartQueue[myStartIndex] = nullptr;
     }
 
     DBG( "BaseObject destroyed" );
@@ -99,6 +247,7 @@ bool BaseObject::IsVisible() const
 void BaseObject::SetPosition( Point const& position )
 {
     myPosition = position;
+    SetDirty();
 }
 
 Point BaseObject::GetPosition() const
@@ -109,6 +258,7 @@ Point BaseObject::GetPosition() const
 void BaseObject::SetAnchor( PointF const& anchor )
 {
     myAnchor = anchor;
+    SetDirty();
 }
 
 PointF BaseObject::GetAnchor() const
@@ -119,6 +269,7 @@ PointF BaseObject::GetAnchor() const
 void BaseObject::SetRotation( float degrees )
 {
     myRotation = degrees;
+    SetDirty();
 }
 
 float BaseObject::GetRotation() const
@@ -129,11 +280,13 @@ float BaseObject::GetRotation() const
 void BaseObject::SetScaling( PointF const& scaling )
 {
     myScaling = scaling;
+    SetDirty();
 }
 
 void BaseObject::SetScaling( float scaling )
 {
     myScaling = PointF( scaling, scaling );
+    SetDirty();
 }
 
 PointF BaseObject::GetScaling() const
@@ -144,6 +297,7 @@ PointF BaseObject::GetScaling() const
 void BaseObject::SetTintR( float r )
 {
 	myTintR = r;
+	SetDirty();
 }
 
 float BaseObject::GetTintR() const
@@ -154,6 +308,7 @@ float BaseObject::GetTintR() const
 void BaseObject::SetTintG( float g )
 {
 	myTintG = g;
+	SetDirty();
 }
 
 float BaseObject::GetTintG() const
@@ -164,6 +319,7 @@ float BaseObject::GetTintG() const
 void BaseObject::SetTintB( float b )
 {
 	myTintB = b;
+	SetDirty();
 }
 
 float BaseObject::GetTintB() const
@@ -176,11 +332,13 @@ void BaseObject::SetTint( float r, float g, float b )
 	myTintR = r;
 	myTintG = g;
 	myTintB = b;
+	SetDirty();
 }
 
 void BaseObject::SetAlpha( float a )
 {
 	myAlpha = a;
+	SetDirty();
 }
 
 float BaseObject::GetAlpha() const
@@ -190,7 +348,34 @@ float BaseObject::GetAlpha() const
 
 void BaseObject::SetParent( BaseObject* parent )
 {
+	if ( parent == myParent )
+	{
+		return;
+	}
+
+	// Refuse to create a loop
+	for ( BaseObject* p = parent; p; p = p->myParent )
+	{
+		if ( p == this )
+		{
+			DBG( "SetParent: cannot parent an object to its own descendant" );
+			return;
+		}
+	}
+
+	if ( myParent )
+	{
+		auto& siblings = myParent->myChildren;
+		siblings.erase( std::find( siblings.begin(), siblings.end(), this ) );
+	}
 	myParent = parent;
+	if ( myParent )
+	{
+		myParent->myChildren.push_back( this );
+	}
+
+	SetDirty();
+	UpdateBranchState();
 }
 
 BaseObject* BaseObject::GetParent() const
@@ -198,6 +383,61 @@ BaseObject* BaseObject::GetParent() const
 	return myParent;
 }
 
+int BaseObject::GetChildCount() const
+{
+	return static_cast<int>( myChildren.size() );
+}
+
+BaseObject* BaseObject::GetChild( int index ) const
+{
+	if ( index < 0 || index >= static_cast<int>( myChildren.size() ) )
+	{
+		return nullptr;
+	}
+	return myChildren[index];
+}
+
+void BaseObject::SetBranchVisible( bool visible )
+{
+	myIsBranchVisible = visible;
+	UpdateBranchState();
+}
+
+bool BaseObject::IsBranchVisible() const
+{
+	return myIsBranchVisible;
+}
+
+void BaseObject::SetBranchEnabled( bool enabled )
+{
+	myIsBranchEnabled = enabled;
+	UpdateBranchState();
+}
+
+bool BaseObject::IsBranchEnabled() const
+{
+	return myIsBranchEnabled;
+}
+
+// Recalculates inherited branch flags and pushes them down to the children
+// whenever they change
+void BaseObject::UpdateBranchState()
+{
+	bool hidden = !myIsBranchVisible || ( myParent && myParent->myIsBranchHidden );
+	bool disabled = !myIsBranchEnabled || ( myParent && myParent->myIsBranchDisabled );
+	if ( hidden == myIsBranchHidden && disabled == myIsBranchDisabled )
+	{
+		return;
+	}
+
+	myIsBranchHidden = hidden;
+	myIsBranchDisabled = disabled;
+	for ( auto i = myChildren.begin(); i != myChildren.end(); ++i )
+	{
+		(*i)->UpdateBranchState();
+	}
+}
+
 void BaseObject::SetAutoUpdated( bool autoUpdated )
 {
     myIsAutoUpdated = autoUpdated;
@@ -220,7 +460,14 @@ bool BaseObject::IsAutoRendered() const
 
 void BaseObject::SetRenderStage( RenderStage stage )
 {
+    if ( stage == myRenderStage || stage < 0 || stage >= NUM_RENDER_STAGES )
+    {
+        return;
+    }
+
+    RemoveFromBucket( this );
     myRenderStage = stage;
+    AddToBucket( this );
 }
 
 BaseObject::RenderStage BaseObject::GetRenderStage() const
@@ -240,7 +487,18 @@ BaseObject::RelativeTo BaseObject::GetRelativeTo() const
 
 void BaseObject::SetRoom( int room )
 {
+    if ( room < 0 )
+    {
+        room = -1;
+    }
+    if ( room == myRoom )
+    {
+        return;
+    }
+
+    RemoveFromBucket( this );
     myRoom = room;
+    AddToBucket( this );
 }
 
 int BaseObject::GetRoom() const
@@ -283,7 +541,7 @@ int BaseObject::Serialize( char* buffer, int bufsize )
 	SERIALIZE( myTintB );
 	SERIALIZE( myAlpha );
 
-	int parentKey = GetAGS()->GetManagedObjectKeyByAddress( (char*)myParent );
+	int parentKey = myParent ? GetAGS()->GetManagedObjectKeyByAddress( (char*)myParent ) : myRestoredParentKey;
 	SERIALIZE( parentKey );
 	
 	SERIALIZE( myWidth );
@@ -296,6 +554,9 @@ int BaseObject::Unserialize( char const* buffer, int size )
 {
     char const* bufStart = buffer;
 
+    // Room and stage are restored below, re-register after
+    RemoveFromBucket( this );
+
     UNSERIALIZE( myHasStarted );
     UNSERIALIZE( myIsEnabled );
     UNSERIALIZE( myIsVisible );
@@ -317,30 +578,113 @@ int BaseObject::Unserialize( char const* buffer, int size )
 	UNSERIALIZE( myTintB );
 	UNSERIALIZE( myAlpha );
 
-	int parentKey;
-	UNSERIALIZE( parentKey );
-	myParent = (BaseObject*)GetAGS()->GetManagedObjectAddressByKey( parentKey );
+	// Parent may not be restored yet, it is looked up before the next start
+	UNSERIALIZE( myRestoredParentKey );
 	
 	UNSERIALIZE( myWidth );
 	UNSERIALIZE( myHeight );
 
+    if ( myRoom < 0 )
+    {
+        myRoom = -1;
+    }
+    AddToBucket( this );
+    SetDirty();
+
+    return buffer - bufStart;
+}
+
+int BaseObject::SerializeExtras( char* buffer, int bufsize )
+{
+    char* bufStart = buffer;
+
+    // Version is always written, as subclass data follows the block
+    int extrasVersion = 1;
+    int needed = sizeof( extrasVersion ) + sizeof( myIsBranchVisible ) + sizeof( myIsBranchEnabled );
+    if ( bufsize < needed )
+    {
+        DBG( "BaseObject extras do not fit in the save buffer" );
+        extrasVersion = 0;
+    }
+    SERIALIZE( extrasVersion );
+    if ( extrasVersion >= 1 )
+    {
+        SERIALIZE( myIsBranchVisible );
+        SERIALIZE( myIsBranchEnabled );
+    }
+
     return buffer - bufStart;
 }
 
+int BaseObject::UnserializeExtras( char const* buffer, int size )
+{
+    char const* bufStart = buffer;
+
+    int extrasVersion = 0;
+    if ( size >= static_cast<int>( sizeof( extrasVersion ) ) )
+    {
+        UNSERIALIZE( extrasVersion );
+    }
+    if ( extrasVersion >= 1 )
+    {
+        UNSERIALIZE( myIsBranchVisible );
+        UNSERIALIZE( myIsBranchEnabled );
+        UpdateBranchState();
+    }
+
+    return buffer - bufStart;
+}
+
+void BaseObject::SetDirty()
+{
+    myIsDirty = true;
+}
+
+BaseObject::WorldState const& BaseObject::ResolveWorld()
+{
+    if ( myWorldFrame == ourFrame && !myIsDirty )
+    {
+        return myWorld;
+    }
+    // Stamp before recursing, this also guards against parenting loops
+    myWorldFrame = ourFrame;
+
+    // Parent is resolved first, and its version tells whether it has changed
+    // since our state was calculated
+    WorldState const* parentWorld = nullptr;
+    if ( myParent )
+    {
+        parentWorld = &myParent->ResolveWorld();
+        if ( myParent->myWorldVersion != myParentVersion )
+        {
+            myIsDirty = true;
+        }
+    }
+
+    if ( myIsDirty )
+    {
+        ComputeWorld( parentWorld );
+        myParentVersion = myParent ? myParent->myWorldVersion : 0;
+        ++myWorldVersion;
+        myIsDirty = false;
+    }
+    return myWorld;
+}
+
 void BaseObject::RenderSelf()
 {
-    if ( !myIsVisible || !myRender )
+    if ( !myIsVisible || myIsBranchHidden || !myRender )
     {
         return;
     }
 
     // Parenting
-    Point pos( 0, 0 );
-	float rotation;
-	PointF scaling( 0, 0 );
-	PointF anchorPos( 0, 0 );
-	RGBA rgba;
-	HandleParenting( &pos, &rotation, &scaling, &anchorPos, &rgba.r, &rgba.g, &rgba.b, &rgba.a );
+    WorldState const& world = ResolveWorld();
+    if ( world.rgba.a <= 0.f )
+    {
+        return;
+    }
+    Point pos = world.position;
 
     auto screen = GetScreen();
 
@@ -366,49 +710,56 @@ void BaseObject::RenderSelf()
         }
     }
 
-    myRender->Render(pos, scaling, rotation, anchorPos, rgba, myFiltering);
+    myWasCulled = !myRender->Render(pos, world.scaling, world.rotation, world.anchor, world.rgba, myFiltering);
+    if ( myWasCulled )
+    {
+        ++ourCulledCount;
+    }
+    else
+    {
+        TextureResidency::Touch( myRender.get() );
+    }
+}
+
+bool BaseObject::IsOutOfSight()
+{
+    if ( !myIsVisible || myIsBranchHidden )
+    {
+        return true;
+    }
+    return ResolveWorld().rgba.a <= 0.f || myWasCulled;
 }
 
-void BaseObject::HandleParenting( Point* outPosition, float* outRotation, PointF* outScaling, PointF* outAnchor,
-								  float* outTintR, float* outTintG, float* outTintB, float* outAlpha ) const
+void BaseObject::ComputeWorld( WorldState const* parent )
 {
-	if ( !myParent )
+	if ( !parent )
 	{
 		// No parent
-		*outPosition = myPosition;
-		*outRotation = myRotation;
-		*outScaling = myScaling;
-		*outAnchor = myAnchor;
-		*outTintR = myTintR;
-		*outTintG = myTintG;
-		*outTintB = myTintB;
-		*outAlpha = myAlpha;
+		myWorld.position = myPosition;
+		myWorld.rotation = myRotation;
+		myWorld.scaling = myScaling;
+		myWorld.anchor = myAnchor;
+		myWorld.rgba.r = myTintR;
+		myWorld.rgba.g = myTintG;
+		myWorld.rgba.b = myTintB;
+		myWorld.rgba.a = myAlpha;
 	}
 	else
 	{
 		// Has parent
-		Point parentPos( 0, 0 );
-		float parentRot;
-		PointF parentScale( 0, 0 );
-		PointF parentAnchor( 0, 0 );
-		float parentR;
-		float parentG;
-		float parentB;
-		float parentA;
-
-		myParent->HandleParenting( &parentPos, &parentRot, &parentScale, &parentAnchor,
-								   &parentR, &parentG, &parentB, &parentA );
-
-		*outRotation = myRotation + parentRot;
-		outScaling->x = myScaling.x * parentScale.x;
-		outScaling->y = myScaling.y * parentScale.y;
-		*outTintR = myTintR * parentR;
-		*outTintG = myTintG * parentG;
-		*outTintB = myTintB * parentB;
-		*outAlpha = myAlpha * parentA;
-
-		outPosition->x = parentPos.x;
-		outPosition->y = parentPos.y;
+		Point parentPos = parent->position;
+		PointF parentAnchor = parent->anchor;
+
+		myWorld.rotation = myRotation + parent->rotation;
+		myWorld.scaling.x = myScaling.x * parent->scaling.x;
+		myWorld.scaling.y = myScaling.y * parent->scaling.y;
+		myWorld.rgba.r = myTintR * parent->rgba.r;
+		myWorld.rgba.g = myTintG * parent->rgba.g;
+		myWorld.rgba.b = myTintB * parent->rgba.b;
+		myWorld.rgba.a = myAlpha * parent->rgba.a;
+
+		myWorld.position.x = parentPos.x;
+		myWorld.position.y = parentPos.y;
 
 		// Parent's absolute anchor position
 		float pax = parentPos.x + parentAnchor.x * myParent->myWidth;
@@ -428,8 +779,8 @@ void BaseObject::HandleParenting( Point* outPosition, float* outRotation, PointF
 		float widthRatio = static_cast<float>( myWidth ) / myParent->myWidth;
 		float heightRatio = static_cast<float>( myHeight ) / myParent->myHeight;
 
-		outAnchor->x = myAnchor.x + dx / myWidth + parentAnchor.x * widthRatio;
-		outAnchor->y = myAnchor.y + dy / myHeight + parentAnchor.y * heightRatio;
-		//DBGF( "Anchor: %f, %f", outAnchor->x, outAnchor->y );
+		myWorld.anchor.x = myAnchor.x + dx / myWidth + parentAnchor.x * widthRatio;
+		myWorld.anchor.y = myAnchor.y + dy / myHeight + parentAnchor.y * heightRatio;
+		//DBGF( "Anchor: %f, %f", myWorld.anchor.x, myWorld.anchor.y );
 	}
 }
@@ -1,8 +1,10 @@
 #ifndef SPRITE3D_BASEOBJECT_H
 #define SPRITE3D_BASEOBJECT_H
 
-#include <list>
+#include <array>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 #include "Common.h"
 #include "RenderObject.h"
 
@@ -25,6 +27,8 @@ public:
         STAGE_SCREEN        = 3
     };
 
+    static int const NUM_RENDER_STAGES = 4;
+
     enum RelativeTo
     {
         RELATIVE_ROOM       = 0,
@@ -33,6 +37,8 @@ public:
 
     static void UpdateAll();
     static void RenderAll( RenderStage stage );
+    // Number of objects culled during the last complete frame
+    static int GetCulledCount();
 
     BaseObject();
     virtual ~BaseObject();
@@ -61,6 +67,13 @@ public:
 	float GetAlpha() const;
 	void SetParent(BaseObject* parent );
     BaseObject* GetParent() const;
+    int GetChildCount() const;
+    BaseObject* GetChild( int index ) const;
+    // Branch visibility and enabled state apply to the object and all its descendants
+    void SetBranchVisible( bool visible );
+    bool IsBranchVisible() const;
+    void SetBranchEnabled( bool enabled );
+    bool IsBranchEnabled() const;
     void SetAutoUpdated( bool autoUpdated );
     bool IsAutoUpdated() const;
     void SetAutoRendered( bool autoRendered );
@@ -82,9 +95,29 @@ public:
     virtual int Unserialize( char const* buffer, int size );
 
 protected:
-	void HandleParenting( Point* outPosition, float* outRotation, PointF* outScaling, PointF* outAnchor,
-						  float* outTintR, float* outTintG, float* outTintB, float* outAlpha ) const;
+    // Optional data written after the subclass data, so that older saves
+    // without it still load
+    int SerializeExtras( char* buffer, int bufsize );
+    int UnserializeExtras( char const* buffer, int size );
+
+    // Transform, tint and alpha resolved through the parent chain
+    struct WorldState
+    {
+        Point position;
+        float rotation = 0.f;
+        PointF scaling;
+        PointF anchor;
+        RGBA rgba;
+    };
+
+    // Marks cached world state for recalculation; descendants notice
+    // this through the parent's world version
+    void SetDirty();
+    WorldState const& ResolveWorld();
     void RenderSelf();
+    // Tells if the object will not be seen this frame: hidden, fully transparent,
+    // or found off screen when it was drawn last time
+    bool IsOutOfSight();
 
     bool myHasStarted = false;
     bool myIsEnabled = true;
@@ -106,14 +139,76 @@ protected:
 	float myTintB = 1.f;
 	float myAlpha = 1.f;
     BaseObject* myParent = nullptr;
+    std::vector< BaseObject* > myChildren;
+    bool myIsBranchVisible = true;
+    bool myIsBranchEnabled = true;
+    // Whether this object or any of its ancestors has its branch hidden / disabled
+    // Culling is still tested per object: children may lie outside of their
+    // parent, so an off-screen root says nothing of its subtree, and bounds of
+    // the whole subtree would need every descendant resolved anyway
+    bool myIsBranchHidden = false;
+    bool myIsBranchDisabled = false;
 
 	int myWidth = 0;
 	int myHeight = 0;
 
-    std::unique_ptr<RenderObject> myRender;
+    std::shared_ptr<RenderObject> myRender; // may be shared with objects of the same source
+    bool myWasCulled = false;
+
+private:
+    void ComputeWorld( WorldState const* parent );
+    void UpdateBranchState();
+
+    // Removed objects leave an empty slot behind, which keeps the indexes
+    // of the rest valid; slots are compacted once holes make up half of them
+    struct Slot
+    {
+        unsigned order;
+        BaseObject* obj;
+    };
+
+    struct Bucket
+    {
+        std::vector< Slot > slots;
+        size_t holes = 0;
+    };
 
-    static std::list< BaseObject* > ourObjects;
-    static std::list< BaseObject* > ourStartQueue;
+    typedef std::array< Bucket, NUM_RENDER_STAGES > StageBuckets;
+
+    static void AddToBucket( BaseObject* obj );
+    static void RemoveFromBucket( BaseObject* obj );
+    static void CompactBucket( Bucket& bucket );
+    template <typename TFunc>
+    static void ForEachInStage( int room, RenderStage stage, TFunc func );
+    // Frees textures of the objects bound to rooms other than the given one
+    static void EvictOtherRooms( int room );
+
+    // Registered objects, bucketed by room (-1 for "any room") and render stage;
+    // each bucket is sorted by creation order
+    static std::unordered_map< int, StageBuckets > ourObjects;
+    static std::vector< BaseObject* > ourStartQueue;
+    static unsigned ourNextOrder;
+    // Counts frames, world state is validated at most once per frame
+    static unsigned ourFrame;
+    static int ourCulledCount;
+    static int ourLastCulledCount;
+    static int ourLastRoom;
+
+    // Creation order, keeps the draw order stable across buckets
+    unsigned myOrder = 0;
+    // Position in the current bucket and in the start queue
+    size_t myBucketIndex = 0;
+    size_t myStartIndex = NO_INDEX;
+
+    WorldState myWorld;
+    bool myIsDirty = true;
+    unsigned myWorldVersion = 0;
+    unsigned myParentVersion = 0;
+    unsigned myWorldFrame = 0;
+    // Parent key read from a save, resolved once all objects are restored
+    int myRestoredParentKey = -1;
+
+    static size_t const NO_INDEX = static_cast<size_t>( -1 );
 };
 
 #endif // SPRITE3D_BASEOBJECT_H
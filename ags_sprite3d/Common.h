@@ -83,18 +83,23 @@ struct Screen
     Point viewport;
     int gameSpeed = 40;
     float frameDelay = 1.f / 40;
+    // Skip drawing objects that are entirely outside of the screen
+    bool culling = true;
 
     // Render stage transform matrixes
     bool matrixValid = false;
     Matrix globalWorld;
     Matrix globalView;
     Matrix globalProj;
+    // globalWorld * globalView * globalProj, same for all objects in the stage
+    Matrix stageMatrix;
 
     Screen()
     {
         memset(&globalWorld, 0, sizeof(float[16]));
         memset(&globalView, 0, sizeof(float[16]));
         memset(&globalProj, 0, sizeof(float[16]));
+        memset(&stageMatrix, 0, sizeof(float[16]));
     }
 
     Point FromRoom(Point pt) const
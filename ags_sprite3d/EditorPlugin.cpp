@@ -29,6 +29,10 @@
 	"	import void SetTint( float r, float g, float b );\r\n"\
 	"	import void SetParent( int parentKey );\r\n"\
 	"	import int GetKey();\r\n"\
+    "   readonly import attribute int childCount;\r\n"\
+    "   import int GetChildKey( int index );\r\n"\
+    "   import attribute bool isBranchVisible;\r\n"\
+    "   import attribute bool isBranchEnabled;\r\n"\
     "   import void Update();\r\n"\
     "   import void Render();\r\n"
 
@@ -58,6 +62,14 @@ const char *ourScriptHeader =
 "   eD3D_RelativeToScreen = 1\r\n"
 "};\r\n\r\n"
 
+// *** D3D_PrefetchMode ***
+"enum D3D_PrefetchMode\r\n"
+"{\r\n"
+"   eD3D_PrefetchOff = 0,\r\n"
+"   eD3D_PrefetchRecord = 1,\r\n"
+"   eD3D_PrefetchPlay = 2\r\n"
+"};\r\n\r\n"
+
 // *** D3D_Sprite ***
 "managed struct D3D_Sprite\r\n"
 "{\r\n"
@@ -65,9 +77,18 @@ const char *ourScriptHeader =
 IMPORT_D3DOBJECT_BASE
 
 // SpriteObject
+"   import bool IsLoading();\r\n"
 "};\r\n\r\n"
 
 #if defined (VIDEO_PLAYBACK)
+// *** D3D_VideoHidden ***
+"enum D3D_VideoHidden\r\n"
+"{\r\n"
+"   eD3D_VideoHiddenUpdate = 0,\r\n"
+"   eD3D_VideoHiddenSkipUpload = 1,\r\n"
+"   eD3D_VideoHiddenPause = 2\r\n"
+"};\r\n\r\n"
+
 // *** D3D_Video ***
 "managed struct D3D_Video\r\n"
 "{\r\n"
@@ -77,11 +98,20 @@ IMPORT_D3DOBJECT_BASE
 // D3DVideoObject    
 "   import attribute bool isLooping;\r\n"
 "   import attribute float fps;\r\n"
+"   import attribute int precachedFrames;\r\n"
+"   import attribute float decodePriority;\r\n"
+"   readonly import attribute int readyFrames;\r\n"
+"   import attribute D3D_VideoHidden hiddenMode;\r\n"
+"   import attribute bool isRealTime;\r\n"
+"   readonly import attribute int droppedFrames;\r\n"
+"   readonly import attribute int lateFrames;\r\n"
 
 "   import bool NextFrame();\r\n"
+"   import void Seek( float time );\r\n"
 "   import void Autoplay();\r\n"
 "   import bool IsAutoplaying();\r\n"
 "   import void StopAutoplay();\r\n"
+"   import bool IsLoading();\r\n"
 "};\r\n\r\n"
 #endif // VIDEO_PLAYBACK
 
@@ -89,8 +119,19 @@ IMPORT_D3DOBJECT_BASE
 "struct D3D\r\n"
 "{\r\n"
 "   import static void SetLoopsPerSecond( int loops );\r\n"
+"   import static void SetCulling( bool enabled );\r\n"
+"   import static int GetCulledCount();\r\n"
+"   import static void SetTextureBudget( int bytes );\r\n"
+"   import static int GetResidentTextureBytes();\r\n"
+"   import static void SetPrefetchManifest( String filename, D3D_PrefetchMode mode );\r\n"
+"   import static void PrefetchRoom( int room );\r\n"
+"   import static bool MountTextureContainer( String filename );\r\n"
 #if defined (VIDEO_PLAYBACK)
 "   import static D3D_Video* OpenVideo( String filename );\r\n"
+"   import static void SetVideoYUV( bool enabled );\r\n"
+"   import static void SetVideoDecodeThreads( int count );\r\n"
+"   import static int GetVideoDecodeThreads();\r\n"
+"   import static void SetVideoPrecache( int frames );\r\n"
 #endif
 "   import static D3D_Sprite* OpenSprite( int graphic );\r\n"
 "   import static D3D_Sprite* OpenSpriteFile( String filename, D3D_Filtering filtering );\r\n"
@@ -0,0 +1,22 @@
+#ifndef SPRITE3D_IMAGECODECS_H
+#define SPRITE3D_IMAGECODECS_H
+
+#include <vector>
+#include "ImageHelper.h"
+
+// Built-in codecs; optional ones are enabled by their build options
+extern const ImageCodec PNGCodec; // libspng with SPNG_SUPPORT, libpng otherwise
+extern const ImageCodec QOICodec;
+#if defined (JPEG_SUPPORT)
+extern const ImageCodec JPEGCodec;
+#endif
+#if defined (WEBP_SUPPORT)
+extern const ImageCodec WebPCodec;
+#endif
+
+// Reads the whole file, for the decoders working from memory
+bool ReadImageFile(const char *file, std::vector<unsigned char> &buf);
+// Swaps red and blue of the RGBA pixels, making them BGRA
+void SwapRedBlue(unsigned char *data, size_t count);
+
+#endif // SPRITE3D_IMAGECODECS_H
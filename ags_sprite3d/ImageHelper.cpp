@@ -1,43 +1,103 @@
 #include "ImageHelper.h"
-#include <png.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
 #include <vector>
 #include "Common.h"
+#include "ImageCodecs.h"
 #include "StringHelper.h"
 
 
-static bool LoadPNG(const char* file, std::vector<unsigned char> &data, ImageInfo &info)
+static std::vector<ImageCodec> &GetCodecs()
 {
-    // http://www.libpng.org/pub/png/libpng-manual.txt
-    // see V. Simplified API
-    png_image im;
-    memset(&im, 0, sizeof(im));
-    im.version = PNG_IMAGE_VERSION;
-    if (png_image_begin_read_from_file(&im, file) == 0)
-        return false;
-    im.format = PNG_FORMAT_BGRA;
-    const int bpp = PNG_IMAGE_SAMPLE_SIZE(im.format);
-    int stride = im.width * bpp;
-    data.resize(stride * im.height);
-    if (png_image_finish_read(&im, nullptr, &data[0], stride, nullptr) == 0)
+    static std::vector<ImageCodec> codecs = {
+#if defined (WEBP_SUPPORT)
+        WebPCodec,
+#endif
+#if defined (JPEG_SUPPORT)
+        JPEGCodec,
+#endif
+        QOICodec,
+        PNGCodec
+    };
+    return codecs;
+}
+
+static bool HasExtension(const ImageCodec &codec, const char *ext)
+{
+    for (const char *e = codec.Extensions; *e; )
+    {
+        size_t n = strcspn(e, ";");
+        if (stricmp(std::string(e, n).c_str(), ext) == 0)
+            return true;
+        e += n;
+        if (*e)
+            e++;
+    }
+    return false;
+}
+
+void RegisterImageCodec(const ImageCodec &codec)
+{
+    auto &codecs = GetCodecs();
+    codecs.insert(codecs.begin(), codec);
+}
+
+bool ReadImageFile(const char *file, std::vector<unsigned char> &buf)
+{
+    FILE *f = fopen(file, "rb");
+    if (!f)
         return false;
-    info.Width = im.width;
-    info.Height = im.height;
-    info.BPP = bpp;
-    info.HasAlpha = (im.format & PNG_FORMAT_FLAG_ALPHA) != 0;
-    return true;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    bool ok = size > 0;
+    if (ok)
+    {
+        buf.resize(size);
+        ok = fread(&buf[0], 1, size, f) == static_cast<size_t>(size);
+    }
+    fclose(f);
+    return ok;
+}
+
+void SwapRedBlue(unsigned char *data, size_t count)
+{
+    for (size_t i = 0; i < count; ++i, data += 4)
+    {
+        unsigned char r = data[0];
+        data[0] = data[2];
+        data[2] = r;
+    }
 }
 
 bool LoadImage(const char* file, std::vector<unsigned char> &data, ImageInfo &info)
 {
+    // Contents are trusted over the name, files are often renamed
+    unsigned char head[16];
+    size_t size = 0;
+    FILE *f = fopen(file, "rb");
+    if (f)
+    {
+        size = fread(head, 1, sizeof(head), f);
+        fclose(f);
+    }
+
+    const auto &codecs = GetCodecs();
+    for (const auto &codec : codecs)
+    {
+        if (codec.Match(head, size))
+            return codec.Load(file, data, info);
+    }
+
     const char* ext = GetExt(file);
     if (!ext)
         ext = ".png"; // just try?
-    else
-        ext++;
-
-    if (stricmp(ext, "png") == 0)
+    ext++;
+    for (const auto &codec : codecs)
     {
-        return LoadPNG(file, data, info);
+        if (HasExtension(codec, ext))
+            return codec.Load(file, data, info);
     }
     DBGF("Image format not supported: %s", file);
     return false; // not supported
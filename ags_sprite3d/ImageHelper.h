@@ -1,6 +1,7 @@
 #ifndef SPRITE3D_IMAGEHELPER_H
 #define SPRITE3D_IMAGEHELPER_H
 
+#include <cstddef>
 #include <vector>
 
 struct ImageInfo
@@ -11,6 +12,21 @@ struct ImageInfo
     bool HasAlpha = false;
 };
 
+// Decoder of an image format; decoded pixels are BGRA, 4 bytes each
+struct ImageCodec
+{
+    const char *Name;
+    // Extensions without the dot, separated by ';'
+    const char *Extensions;
+    // Tells if the first bytes of a file are of this format
+    bool (*Match)(const unsigned char *head, size_t size);
+    bool (*Load)(const char *file, std::vector<unsigned char> &data, ImageInfo &info);
+};
+
+// Adds a codec, checked before the ones registered earlier and the built-in
+// ones; must be done before any images are loaded
+void RegisterImageCodec(const ImageCodec &codec);
+// Picks the codec by the file contents, or by the extension if none match
 bool LoadImage(const char* file, std::vector<unsigned char> &data, ImageInfo &info);
 
 
@@ -0,0 +1,92 @@
+#if defined (JPEG_SUPPORT)
+
+#include "ImageCodecs.h"
+#include <csetjmp>
+#include <cstdio>
+#include <jpeglib.h>
+#include "Common.h"
+
+// libjpeg-turbo decodes with SIMD and converts straight to BGRA;
+// plain libjpeg gives RGB, which is expanded here
+
+struct JPEGError
+{
+    jpeg_error_mgr mgr;
+    jmp_buf jump;
+};
+
+static void OnJPEGError(j_common_ptr cinfo)
+{
+    char message[JMSG_LENGTH_MAX];
+    (*cinfo->err->format_message)(cinfo, message);
+    DBGF("JPEG error: %s", message);
+    longjmp(reinterpret_cast<JPEGError*>(cinfo->err)->jump, 1);
+}
+
+static bool IsJPEG(const unsigned char *head, size_t size)
+{
+    return size >= 3 && head[0] == 0xFF && head[1] == 0xD8 && head[2] == 0xFF;
+}
+
+static bool LoadJPEG(const char* file, std::vector<unsigned char> &data, ImageInfo &info)
+{
+    std::vector<unsigned char> buf;
+    if (!ReadImageFile(file, buf))
+        return false;
+
+    jpeg_decompress_struct cinfo;
+    JPEGError error;
+    cinfo.err = jpeg_std_error(&error.mgr);
+    error.mgr.error_exit = OnJPEGError;
+    if (setjmp(error.jump))
+    {
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, &buf[0], static_cast<unsigned long>(buf.size()));
+    jpeg_read_header(&cinfo, TRUE);
+#if defined (JCS_EXTENSIONS)
+    cinfo.out_color_space = JCS_EXT_BGRA;
+#else
+    cinfo.out_color_space = JCS_RGB;
+#endif
+    jpeg_start_decompress(&cinfo);
+
+    const int width = cinfo.output_width;
+    const int height = cinfo.output_height;
+    const int stride = width * cinfo.output_components;
+    data.resize(static_cast<size_t>(width) * height * 4);
+    while (cinfo.output_scanline < cinfo.output_height)
+    {
+        JSAMPROW row = &data[static_cast<size_t>(cinfo.output_scanline) * stride];
+        jpeg_read_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+
+#if !defined (JCS_EXTENSIONS)
+    // Expand from the end, RGB rows are packed at the start of the buffer
+    for (size_t i = static_cast<size_t>(width) * height; i-- > 0; )
+    {
+        unsigned char *dst = &data[i * 4];
+        const unsigned char *src = &data[i * 3];
+        unsigned char r = src[0], g = src[1], b = src[2];
+        dst[0] = b;
+        dst[1] = g;
+        dst[2] = r;
+        dst[3] = 255;
+    }
+#endif
+
+    info.Width = width;
+    info.Height = height;
+    info.BPP = 4;
+    info.HasAlpha = false;
+    return true;
+}
+
+const ImageCodec JPEGCodec = { "jpeg", "jpg;jpeg", IsJPEG, LoadJPEG };
+
+#endif // JPEG_SUPPORT
@@ -0,0 +1,91 @@
+#include "ImageLoader.h"
+#include <algorithm>
+
+// Decoding is bound by memory and disk as much as by the CPU
+static const unsigned MaxWorkers = 4;
+
+std::vector< std::thread > ImageLoader::ourWorkers;
+std::mutex ImageLoader::ourMutex;
+std::condition_variable ImageLoader::ourCondition;
+std::deque< std::string > ImageLoader::ourQueue;
+std::set< std::string > ImageLoader::ourPending;
+std::deque< ImageLoader::Image > ImageLoader::ourCompleted;
+bool ImageLoader::ourIsStopping = false;
+
+void ImageLoader::Request( std::string const& filename )
+{
+    {
+        std::lock_guard< std::mutex > lock( ourMutex );
+        if ( !ourPending.insert( filename ).second )
+        {
+            return;
+        }
+        ourQueue.push_back( filename );
+    }
+    ourCondition.notify_one();
+
+    // Workers are started on the first request; leave a core for the engine
+    if ( ourWorkers.empty() )
+    {
+        unsigned count = std::max( std::thread::hardware_concurrency(), 2u ) - 1;
+        count = std::min( count, MaxWorkers );
+        for ( unsigned n = 0; n < count; ++n )
+        {
+            ourWorkers.emplace_back( Work );
+        }
+    }
+}
+
+bool ImageLoader::PopCompleted( Image& image )
+{
+    std::lock_guard< std::mutex > lock( ourMutex );
+    if ( ourCompleted.empty() )
+    {
+        return false;
+    }
+    image = std::move( ourCompleted.front() );
+    ourCompleted.pop_front();
+    return true;
+}
+
+void ImageLoader::CleanUp()
+{
+    {
+        std::lock_guard< std::mutex > lock( ourMutex );
+        ourIsStopping = true;
+        ourQueue.clear();
+    }
+    ourCondition.notify_all();
+    for ( auto& worker : ourWorkers )
+    {
+        worker.join();
+    }
+    ourWorkers.clear();
+    ourPending.clear();
+    ourCompleted.clear();
+    ourIsStopping = false;
+}
+
+void ImageLoader::Work()
+{
+    std::unique_lock< std::mutex > lock( ourMutex );
+    for ( ;; )
+    {
+        ourCondition.wait( lock, [] { return ourIsStopping || !ourQueue.empty(); } );
+        if ( ourIsStopping )
+        {
+            return;
+        }
+
+        Image image;
+        image.Filename = ourQueue.front();
+        ourQueue.pop_front();
+
+        lock.unlock();
+        image.IsValid = LoadImage( image.Filename.c_str(), image.Data, image.Info );
+        lock.lock();
+
+        ourPending.erase( image.Filename );
+        ourCompleted.push_back( std::move( image ) );
+    }
+}
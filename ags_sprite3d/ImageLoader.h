@@ -0,0 +1,47 @@
+#ifndef SPRITE3D_IMAGELOADER_H
+#define SPRITE3D_IMAGELOADER_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ImageHelper.h"
+
+// Decodes image files on worker threads. Decoded images wait in the
+// completion queue until taken on the engine thread, which is the only
+// one allowed to create textures.
+class ImageLoader
+{
+public:
+    struct Image
+    {
+        std::string Filename;
+        std::vector<unsigned char> Data;
+        ImageInfo Info;
+        bool IsValid = false;
+    };
+
+    // Queues the file for decoding, unless it is queued already
+    static void Request( std::string const& filename );
+    // Takes the next decoded image, returns false if there are none yet
+    static bool PopCompleted( Image& image );
+    // Stops the workers, dropping the queued files
+    static void CleanUp();
+
+private:
+    static void Work();
+
+    static std::vector< std::thread > ourWorkers;
+    static std::mutex ourMutex;
+    static std::condition_variable ourCondition;
+    static std::deque< std::string > ourQueue;
+    // Files queued or being decoded
+    static std::set< std::string > ourPending;
+    static std::deque< Image > ourCompleted;
+    static bool ourIsStopping;
+};
+
+#endif // SPRITE3D_IMAGELOADER_H
@@ -0,0 +1,76 @@
+#include "ImageCodecs.h"
+#include <cstdio>
+#include <cstring>
+#if defined (SPNG_SUPPORT)
+#include <spng.h>
+#else
+#include <png.h>
+#endif
+
+
+static bool IsPNG(const unsigned char *head, size_t size)
+{
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    return size >= sizeof(signature) && memcmp(head, signature, sizeof(signature)) == 0;
+}
+
+#if defined (SPNG_SUPPORT)
+
+// libspng decodes considerably faster than libpng, but only to RGBA
+static bool LoadPNG(const char* file, std::vector<unsigned char> &data, ImageInfo &info)
+{
+    FILE *f = fopen(file, "rb");
+    if (!f)
+        return false;
+    spng_ctx *ctx = spng_ctx_new(0);
+    struct spng_ihdr ihdr;
+    size_t size = 0;
+    bool ok = ctx && spng_set_png_file(ctx, f) == 0 && spng_get_ihdr(ctx, &ihdr) == 0 &&
+        spng_decoded_image_size(ctx, SPNG_FMT_RGBA8, &size) == 0;
+    if (ok)
+    {
+        data.resize(size);
+        ok = spng_decode_image(ctx, &data[0], size, SPNG_FMT_RGBA8, SPNG_DECODE_TRNS) == 0;
+    }
+    if (ok)
+    {
+        struct spng_trns trns;
+        info.Width = ihdr.width;
+        info.Height = ihdr.height;
+        info.BPP = 4;
+        info.HasAlpha = ihdr.color_type == SPNG_COLOR_TYPE_TRUECOLOR_ALPHA ||
+            ihdr.color_type == SPNG_COLOR_TYPE_GRAYSCALE_ALPHA || spng_get_trns(ctx, &trns) == 0;
+        SwapRedBlue(&data[0], size / 4);
+    }
+    spng_ctx_free(ctx);
+    fclose(f);
+    return ok;
+}
+
+#else // !SPNG_SUPPORT
+
+static bool LoadPNG(const char* file, std::vector<unsigned char> &data, ImageInfo &info)
+{
+    // http://www.libpng.org/pub/png/libpng-manual.txt
+    // see V. Simplified API
+    png_image im;
+    memset(&im, 0, sizeof(im));
+    im.version = PNG_IMAGE_VERSION;
+    if (png_image_begin_read_from_file(&im, file) == 0)
+        return false;
+    im.format = PNG_FORMAT_BGRA;
+    const int bpp = PNG_IMAGE_SAMPLE_SIZE(im.format);
+    int stride = im.width * bpp;
+    data.resize(stride * im.height);
+    if (png_image_finish_read(&im, nullptr, &data[0], stride, nullptr) == 0)
+        return false;
+    info.Width = im.width;
+    info.Height = im.height;
+    info.BPP = bpp;
+    info.HasAlpha = (im.format & PNG_FORMAT_FLAG_ALPHA) != 0;
+    return true;
+}
+
+#endif // SPNG_SUPPORT
+
+const ImageCodec PNGCodec = { "png", "png", IsPNG, LoadPNG };
@@ -0,0 +1,100 @@
+#include "ImageCodecs.h"
+#include <cstring>
+
+// "Quite OK Image" format, see https://qoiformat.org/qoi-specification.pdf;
+// simple enough to decode here, and several times faster than PNG
+
+static const size_t HeaderSize = 14;
+static const size_t PaddingSize = 8;
+// Same limit as in the reference decoder
+static const unsigned MaxPixels = 400000000;
+
+static bool IsQOI(const unsigned char *head, size_t size)
+{
+    return size >= 4 && memcmp(head, "qoif", 4) == 0;
+}
+
+static unsigned ReadBE32(const unsigned char *p)
+{
+    return (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+static bool LoadQOI(const char* file, std::vector<unsigned char> &data, ImageInfo &info)
+{
+    std::vector<unsigned char> buf;
+    if (!ReadImageFile(file, buf) || buf.size() < HeaderSize + PaddingSize || !IsQOI(&buf[0], buf.size()))
+        return false;
+
+    const unsigned width = ReadBE32(&buf[4]);
+    const unsigned height = ReadBE32(&buf[8]);
+    const int channels = buf[12];
+    if (width == 0 || height == 0 || height >= MaxPixels / width || (channels != 3 && channels != 4))
+        return false;
+
+    const size_t count = static_cast<size_t>(width) * height;
+    data.resize(count * 4);
+    unsigned char index[64][4] = {};
+    unsigned char px[4] = { 0, 0, 0, 255 }; // r, g, b, a
+    const unsigned char *p = &buf[HeaderSize];
+    const unsigned char *end = &buf[0] + buf.size() - PaddingSize;
+    unsigned char *out = &data[0];
+    int run = 0;
+    for (size_t i = 0; i < count; ++i, out += 4)
+    {
+        if (run > 0)
+        {
+            run--;
+        }
+        else if (p < end)
+        {
+            const int b1 = *p++;
+            if (b1 == 0xFE) // QOI_OP_RGB
+            {
+                px[0] = p[0];
+                px[1] = p[1];
+                px[2] = p[2];
+                p += 3;
+            }
+            else if (b1 == 0xFF) // QOI_OP_RGBA
+            {
+                memcpy(px, p, 4);
+                p += 4;
+            }
+            else if ((b1 & 0xC0) == 0x00) // QOI_OP_INDEX
+            {
+                memcpy(px, index[b1], 4);
+            }
+            else if ((b1 & 0xC0) == 0x40) // QOI_OP_DIFF
+            {
+                px[0] += ((b1 >> 4) & 0x03) - 2;
+                px[1] += ((b1 >> 2) & 0x03) - 2;
+                px[2] += (b1 & 0x03) - 2;
+            }
+            else if ((b1 & 0xC0) == 0x80) // QOI_OP_LUMA
+            {
+                const int b2 = *p++;
+                const int vg = (b1 & 0x3F) - 32;
+                px[0] += vg - 8 + ((b2 >> 4) & 0x0F);
+                px[1] += vg;
+                px[2] += vg - 8 + (b2 & 0x0F);
+            }
+            else // QOI_OP_RUN
+            {
+                run = b1 & 0x3F;
+            }
+            memcpy(index[(px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64], px, 4);
+        }
+        out[0] = px[2];
+        out[1] = px[1];
+        out[2] = px[0];
+        out[3] = px[3];
+    }
+
+    info.Width = width;
+    info.Height = height;
+    info.BPP = 4;
+    info.HasAlpha = channels == 4;
+    return true;
+}
+
+const ImageCodec QOICodec = { "qoi", "qoi", IsQOI, LoadQOI };
@@ -0,0 +1,36 @@
+#if defined (WEBP_SUPPORT)
+
+#include "ImageCodecs.h"
+#include <cstring>
+#include <webp/decode.h>
+
+static bool IsWebP(const unsigned char *head, size_t size)
+{
+    return size >= 12 && memcmp(head, "RIFF", 4) == 0 && memcmp(head + 8, "WEBP", 4) == 0;
+}
+
+static bool LoadWebP(const char* file, std::vector<unsigned char> &data, ImageInfo &info)
+{
+    std::vector<unsigned char> buf;
+    if (!ReadImageFile(file, buf))
+        return false;
+
+    WebPBitstreamFeatures features;
+    if (WebPGetFeatures(&buf[0], buf.size(), &features) != VP8_STATUS_OK)
+        return false;
+
+    const int stride = features.width * 4;
+    data.resize(static_cast<size_t>(stride) * features.height);
+    if (!WebPDecodeBGRAInto(&buf[0], buf.size(), &data[0], data.size(), stride))
+        return false;
+
+    info.Width = features.width;
+    info.Height = features.height;
+    info.BPP = 4;
+    info.HasAlpha = features.has_alpha != 0;
+    return true;
+}
+
+const ImageCodec WebPCodec = { "webp", "webp", IsWebP, LoadWebP };
+
+#endif // WEBP_SUPPORT
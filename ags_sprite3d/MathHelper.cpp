@@ -1,6 +1,13 @@
 #include "MathHelper.h"
 #include <cmath>
 #include <cstring>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MATH_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define MATH_NEON 1
+#include <arm_neon.h>
+#endif
 
 
 void SetMatrix(Matrix* matrix, float tx, float ty, float sx, float sy)
@@ -84,6 +91,25 @@ void MatrixMulD3D(Matrix* result, const Matrix* a, const Matrix* b)
     memcpy(result->m, temp.m, sizeof(Matrix::m));
 }
 
+bool IsRectOutsideClip(const Matrix* m, float x0, float y0, float x1, float y1)
+{
+    const float xs[4] = { x0, x1, x0, x1 };
+    const float ys[4] = { y0, y0, y1, y1 };
+    // Count corners beyond each of the four side planes
+    int left = 0, right = 0, bottom = 0, top = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        float x = xs[i] * m->_11 + ys[i] * m->_21 + m->_41;
+        float y = xs[i] * m->_12 + ys[i] * m->_22 + m->_42;
+        float w = xs[i] * m->_14 + ys[i] * m->_24 + m->_44;
+        left += x < -w;
+        right += x > w;
+        bottom += y < -w;
+        top += y > w;
+    }
+    return left == 4 || right == 4 || bottom == 4 || top == 4;
+}
+
 void MatrixMulOGL(Matrix* result, const Matrix* a, const Matrix* b)
 {
     Matrix temp;
@@ -99,3 +125,116 @@ void MatrixMulOGL(Matrix* result, const Matrix* a, const Matrix* b)
     }
     memcpy(result->marr, temp.marr, sizeof(Matrix::marr));
 }
+
+void SetAffine(Affine2D* t, float tx, float ty, float sx, float sy, float radians, float ax, float ay)
+{
+    // Anchor offset goes through scaling and rotation too
+    float ox = ax;
+    float oy = ay;
+    if (sx != 1.f || sy != 1.f)
+    {
+        ox *= sx;
+        oy *= sy;
+    }
+
+    if (radians == 0.f)
+    {
+        t->a = sx;
+        t->b = 0.f;
+        t->c = 0.f;
+        t->d = sy;
+        t->tx = ox + tx;
+        t->ty = oy + ty;
+        return;
+    }
+
+    float sin = sinf(radians);
+    float cos = cosf(radians);
+    t->a = sx * cos;
+    t->b = -sx * sin;
+    t->c = sy * sin;
+    t->d = sy * cos;
+    t->tx = ox * cos + oy * sin + tx;
+    t->ty = -ox * sin + oy * cos + ty;
+}
+
+void MatrixMulAffine(Matrix* result, const Affine2D* t, const Matrix* m)
+{
+    // Affine has no z, so the third row passes through
+#if MATH_SSE2
+    __m128 row0 = _mm_loadu_ps(m->m[0]);
+    __m128 row1 = _mm_loadu_ps(m->m[1]);
+    __m128 row2 = _mm_loadu_ps(m->m[2]);
+    __m128 row3 = _mm_loadu_ps(m->m[3]);
+    __m128 r0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t->a), row0), _mm_mul_ps(_mm_set1_ps(t->b), row1));
+    __m128 r1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t->c), row0), _mm_mul_ps(_mm_set1_ps(t->d), row1));
+    __m128 r3 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(t->tx), row0), _mm_mul_ps(_mm_set1_ps(t->ty), row1)), row3);
+    _mm_storeu_ps(result->m[0], r0);
+    _mm_storeu_ps(result->m[1], r1);
+    _mm_storeu_ps(result->m[2], row2);
+    _mm_storeu_ps(result->m[3], r3);
+#elif MATH_NEON
+    float32x4_t row0 = vld1q_f32(m->m[0]);
+    float32x4_t row1 = vld1q_f32(m->m[1]);
+    float32x4_t row2 = vld1q_f32(m->m[2]);
+    float32x4_t row3 = vld1q_f32(m->m[3]);
+    float32x4_t r0 = vaddq_f32(vmulq_n_f32(row0, t->a), vmulq_n_f32(row1, t->b));
+    float32x4_t r1 = vaddq_f32(vmulq_n_f32(row0, t->c), vmulq_n_f32(row1, t->d));
+    float32x4_t r3 = vaddq_f32(vaddq_f32(vmulq_n_f32(row0, t->tx), vmulq_n_f32(row1, t->ty)), row3);
+    vst1q_f32(result->m[0], r0);
+    vst1q_f32(result->m[1], r1);
+    vst1q_f32(result->m[2], row2);
+    vst1q_f32(result->m[3], r3);
+#else
+    Matrix temp;
+    for (int i = 0; i < 4; ++i)
+    {
+        temp.m[0][i] = t->a * m->m[0][i] + t->b * m->m[1][i];
+        temp.m[1][i] = t->c * m->m[0][i] + t->d * m->m[1][i];
+        temp.m[2][i] = m->m[2][i];
+        temp.m[3][i] = t->tx * m->m[0][i] + t->ty * m->m[1][i] + m->m[3][i];
+    }
+    memcpy(result->marr, temp.marr, sizeof(Matrix::marr));
+#endif
+}
+
+void TransformUnitQuads(const float* src, size_t srcStride, size_t count, float* dst, size_t dstStride)
+{
+    const char* in = reinterpret_cast<const char*>(src);
+    char* out = reinterpret_cast<char*>(dst);
+    for (size_t i = 0; i < count; ++i, in += srcStride)
+    {
+        const float* rows = reinterpret_cast<const float*>(in);
+        float* p0 = reinterpret_cast<float*>(out);
+        float* p1 = reinterpret_cast<float*>(out + dstStride);
+        float* p2 = reinterpret_cast<float*>(out + dstStride * 2);
+        float* p3 = reinterpret_cast<float*>(out + dstStride * 3);
+        out += dstStride * 4;
+#if MATH_SSE2
+        __m128 x = _mm_loadu_ps(rows);
+        __m128 y = _mm_loadu_ps(rows + 4);
+        __m128 w = _mm_loadu_ps(rows + 8);
+        _mm_storeu_ps(p0, w);
+        _mm_storeu_ps(p1, _mm_add_ps(x, w));
+        _mm_storeu_ps(p2, _mm_sub_ps(w, y));
+        _mm_storeu_ps(p3, _mm_add_ps(_mm_sub_ps(x, y), w));
+#elif MATH_NEON
+        float32x4_t x = vld1q_f32(rows);
+        float32x4_t y = vld1q_f32(rows + 4);
+        float32x4_t w = vld1q_f32(rows + 8);
+        vst1q_f32(p0, w);
+        vst1q_f32(p1, vaddq_f32(x, w));
+        vst1q_f32(p2, vsubq_f32(w, y));
+        vst1q_f32(p3, vaddq_f32(vsubq_f32(x, y), w));
+#else
+        for (int k = 0; k < 4; ++k)
+        {
+            float x = rows[k], y = rows[4 + k], w = rows[8 + k];
+            p0[k] = w;
+            p1[k] = x + w;
+            p2[k] = w - y;
+            p3[k] = (x - y) + w;
+        }
+#endif
+    }
+}
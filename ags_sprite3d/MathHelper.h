@@ -1,6 +1,8 @@
 #ifndef SPRITE3D_MATHHELPER_H
 #define SPRITE3D_MATHHELPER_H
 
+#include <cstddef>
+
 float const RADS_PER_DEGREE = 3.14159265f / 180.f;
 
 struct Point
@@ -38,6 +40,17 @@ struct Matrix
     Matrix() = default;
 };
 
+// 2D affine transform, in the same row vector convention as Matrix:
+// point (x, y) becomes (x * a + y * c + tx, x * b + y * d + ty)
+struct Affine2D
+{
+    float a = 1.f, b = 0.f;
+    float c = 0.f, d = 1.f;
+    float tx = 0.f, ty = 0.f;
+
+    Affine2D() = default;
+};
+
 struct RGBA
 {
     union
@@ -59,5 +72,17 @@ void SetMatrixIdentity(Matrix* matrix);
 void SetMatrixRotation(Matrix* matrix, float radians);
 void MatrixMulD3D(Matrix* result, const Matrix* ma, const Matrix* mb);
 void MatrixMulOGL(Matrix* result, const Matrix* ma, const Matrix* mb);
+// Affine functions
+// Makes transform which moves by anchor, then scales, rotates and moves to position
+void SetAffine(Affine2D* t, float tx, float ty, float sx, float sy, float radians, float ax, float ay);
+// Result is the 2D transform followed by the matrix, same as MatrixMulD3D(result, t, m)
+void MatrixMulAffine(Matrix* result, const Affine2D* t, const Matrix* m);
+// Transforms corners (0,0), (1,0), (0,-1), (1,-1) of a number of unit quads.
+// Source of each quad is rows 1, 2 and 4 of its matrix, as 12 consecutive floats;
+// result is 4 positions of 4 floats, each following the previous one by dstStride bytes.
+void TransformUnitQuads(const float* src, size_t srcStride, size_t count, float* dst, size_t dstStride);
+// Tests whether rectangle, transformed by the full world-view-projection matrix,
+// lies completely outside of the clip space
+bool IsRectOutsideClip(const Matrix* mvp, float x0, float y0, float x1, float y1);
 
 #endif // SPRITE3D_MATHHELPER_H
@@ -9,10 +9,17 @@ struct Screen;
 class RenderFactory
 {
 public:
+    virtual ~RenderFactory() = default;
     virtual void InitGfxDevice(void* data) = 0;
     virtual bool InitGfxMode(Screen* screen, void* data) = 0;
     virtual void SetScreenMatrixes(Screen* screen, float(*world)[16], float(*view)[16], float(*proj)[16]) = 0;
     virtual std::unique_ptr<RenderObject> CreateRenderObject() = 0;
+    // Tells if render objects can take YUV pixels, see RenderObject::CreateYUVTexture
+    virtual bool IsYUVSupported() = 0;
+    // Called before any object of the render stage is rendered
+    virtual void BeginRenderStage() = 0;
+    // Called after all objects of the render stage were rendered
+    virtual void EndRenderStage() = 0;
 };
 
 #endif // SPRITE3D_RENDERFACTORY_H
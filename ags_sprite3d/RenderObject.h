@@ -1,6 +1,9 @@
 #ifndef SPRITE3D_RENDEROBJECT_H
 #define SPRITE3D_RENDEROBJECT_H
 
+#include <cstddef>
+#include <vector>
+#include "ImageHelper.h"
 #include "MathHelper.h"
 
 class RenderObject
@@ -9,12 +12,24 @@ public:
     virtual ~RenderObject() = default;
 
     virtual void CreateTexture(int sprite_id, int bkg_num, const char *file) = 0;
+    // Same as creating from the file, with the image already decoded
+    virtual void CreateTexture(const char *file, const std::vector<unsigned char> &data, const ImageInfo &info) = 0;
     virtual void CreateTexture(const unsigned char* data, int width, int height, int bpp) = 0;
-    virtual void Render(const Point &pos, const PointF &scaling, float rotation, const PointF &anchorPos,
+    // Takes packed 8-bit Y, U, V pixels and converts them to RGB when drawing
+    virtual void CreateYUVTexture(const unsigned char* data, int width, int height) = 0;
+    // Returns false if the object was culled as being outside of the screen
+    virtual bool Render(const Point &pos, const PointF &scaling, float rotation, const PointF &anchorPos,
         const RGBA &rgba, int filtering) = 0;
     virtual int GetTexWidth() = 0;
     virtual int GetTexHeight() = 0;
     virtual bool GetHasAlpha() = 0;
+
+    // Texture memory which Evict would free, 0 if it cannot be evicted
+    virtual size_t GetMemorySize() = 0;
+    // Frees the texture, which is created again from its source when drawn next time
+    virtual void Evict() = 0;
+    // Room which background the texture was made from, -1 if not a background
+    virtual int GetSourceRoom() = 0;
 };
 
 #endif // SPRITE3D_RENDEROBJECT_H
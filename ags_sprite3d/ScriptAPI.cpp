@@ -2,6 +2,9 @@
 #include "Common.h"
 #include "SpriteObject.h"
 #include "StringHelper.h"
+#include "TextureContainer.h"
+#include "TexturePrefetch.h"
+#include "TextureResidency.h"
 #include "VideoObject.h"
 
 // AGS:n float-tyypin muunnokset
@@ -26,6 +29,45 @@ void D3D_SetGameSpeed(int speed)
     screen.frameDelay = 1.f / speed;
 }
 
+void D3D_SetCulling(bool enabled)
+{
+    screen.culling = enabled;
+}
+
+int D3D_GetCulledCount()
+{
+    return BaseObject::GetCulledCount();
+}
+
+void D3D_SetTextureBudget(int bytes)
+{
+    TextureResidency::SetBudget(bytes > 0 ? static_cast<size_t>(bytes) : 0);
+}
+
+int D3D_GetResidentTextureBytes()
+{
+    return static_cast<int>(TextureResidency::GetResidentBytes());
+}
+
+void D3D_SetPrefetchManifest(char const* filename, int mode)
+{
+    char buffer[MAX_PATH];
+    GetAGS()->GetPathToFileInCompiledFolder(filename, buffer);
+    TexturePrefetch::SetMode(buffer, (TexturePrefetch::Mode)mode);
+}
+
+void D3D_PrefetchRoom(int room)
+{
+    TexturePrefetch::PrefetchRoom(room);
+}
+
+int D3D_MountTextureContainer(char const* filename)
+{
+    char buffer[MAX_PATH];
+    GetAGS()->GetPathToFileInCompiledFolder(filename, buffer);
+    return TextureContainer::Mount(buffer);
+}
+
 SpriteObject* D3D_OpenSprite(int spriteID)
 {
     SpriteObject* obj = SpriteObject::Open(spriteID);
@@ -81,6 +123,26 @@ VideoObject* D3D_OpenVideo(char const* filename)
 
     return obj;
 }
+
+void D3D_SetVideoYUV(bool enabled)
+{
+    VideoObject::SetYUVOutput(enabled);
+}
+
+void D3D_SetVideoDecodeThreads(int count)
+{
+    VideoObject::SetDecodeThreads(count);
+}
+
+int D3D_GetVideoDecodeThreads()
+{
+    return VideoObject::GetDecodeThreads();
+}
+
+void D3D_SetVideoPrecache(int frames)
+{
+    VideoObject::SetDefaultPrecache(frames);
+}
 #endif
 
 
@@ -194,9 +256,21 @@ void D3DObject_SetTint(BaseObject* obj, SCRIPT_FLOAT(r), SCRIPT_FLOAT(g), SCRIPT
 
 void D3DObject_SetParent(BaseObject* obj, int key) { obj->SetParent((BaseObject*)GetAGS()->GetManagedObjectAddressByKey(key)); }
 int D3DObject_GetKey(BaseObject* obj) { return GetAGS()->GetManagedObjectKeyByAddress((char*)obj); }
+int D3DObject_GetChildCount(BaseObject* obj) { return obj->GetChildCount(); }
+int D3DObject_GetChildKey(BaseObject* obj, int index) {
+    BaseObject* child = obj->GetChild(index);
+    return child ? GetAGS()->GetManagedObjectKeyByAddress((char*)child) : 0;
+}
+void D3DObject_SetBranchVisible(BaseObject* obj, bool visible) { obj->SetBranchVisible(visible); }
+int D3DObject_GetBranchVisible(BaseObject* obj) { return obj->IsBranchVisible(); }
+void D3DObject_SetBranchEnabled(BaseObject* obj, bool enabled) { obj->SetBranchEnabled(enabled); }
+int D3DObject_GetBranchEnabled(BaseObject* obj) { return obj->IsBranchEnabled(); }
 void D3DObject_Update(BaseObject* obj) { obj->Update(); }
 void D3DObject_Render(BaseObject* obj) { manualRenderBatch.push_back(obj); }
 
+// *** SpriteObject ***
+int D3DSpriteObject_IsLoading(SpriteObject* obj) { return obj->IsLoading(); }
+
 // *** VideoObject ***
 #if defined (VIDEO_PLAYBACK)
 
@@ -213,9 +287,32 @@ FLOAT_RETURN_TYPE D3DVideoObject_GetFPS(VideoObject* obj) {
 }
 
 int D3DVideoObject_NextFrame(VideoObject* obj) { return obj->NextFrame(); }
+void D3DVideoObject_Seek(VideoObject* obj, SCRIPT_FLOAT(time)) {
+    INIT_SCRIPT_FLOAT(time);
+    obj->Seek(time);
+}
 void D3DVideoObject_Autoplay(VideoObject* obj) { obj->Autoplay(); }
 int D3DVideoObject_IsAutoplaying(VideoObject* obj) { return obj->IsAutoplaying(); }
 void D3DVideoObject_StopAutoplay(VideoObject* obj) { obj->StopAutoplay(); }
+int D3DVideoObject_IsLoading(VideoObject* obj) { return obj->IsLoading(); }
+
+void D3DVideoObject_SetPrecachedFrames(VideoObject* obj, int frames) { obj->SetPrecachedFrames(frames); }
+int D3DVideoObject_GetPrecachedFrames(VideoObject* obj) { return obj->GetPrecachedFrames(); }
+void D3DVideoObject_SetDecodePriority(VideoObject* obj, SCRIPT_FLOAT(priority)) {
+    INIT_SCRIPT_FLOAT(priority);
+    obj->SetDecodePriority(priority);
+}
+FLOAT_RETURN_TYPE D3DVideoObject_GetDecodePriority(VideoObject* obj) {
+    float priority = obj->GetDecodePriority();
+    RETURN_FLOAT(priority);
+}
+int D3DVideoObject_GetReadyFrames(VideoObject* obj) { return obj->GetReadyFrames(); }
+void D3DVideoObject_SetHiddenMode(VideoObject* obj, int mode) { obj->SetHiddenMode((VideoObject::HiddenMode)mode); }
+int D3DVideoObject_GetHiddenMode(VideoObject* obj) { return obj->GetHiddenMode(); }
+void D3DVideoObject_SetRealTime(VideoObject* obj, bool enabled) { obj->SetRealTime(enabled); }
+int D3DVideoObject_GetRealTime(VideoObject* obj) { return obj->IsRealTime(); }
+int D3DVideoObject_GetDroppedFrames(VideoObject* obj) { return obj->GetDroppedFrames(); }
+int D3DVideoObject_GetLateFrames(VideoObject* obj) { return obj->GetLateFrames(); }
 
 #endif
 
@@ -266,6 +363,13 @@ void dummy(BaseObject* obj) {}
 	REG( cname "::SetTint^3", D3DObject_SetTint );\
 	REG( cname "::SetParent^1", D3DObject_SetParent );\
 	REG( cname "::GetKey^0", D3DObject_GetKey );\
+    REG( cname "::get_childCount", D3DObject_GetChildCount );\
+    REG( cname "::set_childCount", dummy );\
+    REG( cname "::GetChildKey^1", D3DObject_GetChildKey );\
+    REG( cname "::set_isBranchVisible", D3DObject_SetBranchVisible );\
+    REG( cname "::get_isBranchVisible", D3DObject_GetBranchVisible );\
+    REG( cname "::set_isBranchEnabled", D3DObject_SetBranchEnabled );\
+    REG( cname "::get_isBranchEnabled", D3DObject_GetBranchEnabled );\
     REG( cname "::Update^0", D3DObject_Update );\
     REG( cname "::Render^0", D3DObject_Render )
 
@@ -292,19 +396,34 @@ void RegisterScriptAPI()
 
     // Lukijat
     engine->AddManagedObjectReader(spriteObjManager.GetType(), &spriteObjManager);
+#if defined (VIDEO_PLAYBACK)
+    engine->AddManagedObjectReader(videoObjManager.GetType(), &videoObjManager);
+#endif
 
     // D3D
     engine->RegisterScriptFunction("D3D::SetLoopsPerSecond", D3D_SetGameSpeed);
+    engine->RegisterScriptFunction("D3D::SetCulling", D3D_SetCulling);
+    engine->RegisterScriptFunction("D3D::GetCulledCount", D3D_GetCulledCount);
+    engine->RegisterScriptFunction("D3D::SetTextureBudget", D3D_SetTextureBudget);
+    engine->RegisterScriptFunction("D3D::GetResidentTextureBytes", D3D_GetResidentTextureBytes);
+    engine->RegisterScriptFunction("D3D::SetPrefetchManifest", D3D_SetPrefetchManifest);
+    engine->RegisterScriptFunction("D3D::PrefetchRoom", D3D_PrefetchRoom);
+    engine->RegisterScriptFunction("D3D::MountTextureContainer", D3D_MountTextureContainer);
     engine->RegisterScriptFunction("D3D::OpenSprite", D3D_OpenSprite);
     engine->RegisterScriptFunction("D3D::OpenSpriteFile", D3D_OpenSpriteFile);
     engine->RegisterScriptFunction("D3D::OpenBackground", D3D_OpenBackground);
 
     // D3DSprite
     REG_D3DOBJECT_BASE("D3D_Sprite");
+    REG("D3D_Sprite::IsLoading^0", D3DSpriteObject_IsLoading);
 
 #if defined (VIDEO_PLAYBACK)
     // D3D
     engine->RegisterScriptFunction("D3D::OpenVideo", D3D_OpenVideo);
+    engine->RegisterScriptFunction("D3D::SetVideoYUV", D3D_SetVideoYUV);
+    engine->RegisterScriptFunction("D3D::SetVideoDecodeThreads", D3D_SetVideoDecodeThreads);
+    engine->RegisterScriptFunction("D3D::GetVideoDecodeThreads", D3D_GetVideoDecodeThreads);
+    engine->RegisterScriptFunction("D3D::SetVideoPrecache", D3D_SetVideoPrecache);
 
     // D3DVideo
     REG_D3DOBJECT_BASE("D3D_Video");
@@ -312,11 +431,24 @@ void RegisterScriptAPI()
     REG("D3D_Video::get_isLooping", D3DVideoObject_GetLooping);
     REG("D3D_Video::set_fps", D3DVideoObject_SetFPS);
     REG("D3D_Video::get_fps", D3DVideoObject_GetFPS);
+    REG("D3D_Video::set_precachedFrames", D3DVideoObject_SetPrecachedFrames);
+    REG("D3D_Video::get_precachedFrames", D3DVideoObject_GetPrecachedFrames);
+    REG("D3D_Video::set_decodePriority", D3DVideoObject_SetDecodePriority);
+    REG("D3D_Video::get_decodePriority", D3DVideoObject_GetDecodePriority);
+    REG("D3D_Video::get_readyFrames", D3DVideoObject_GetReadyFrames);
+    REG("D3D_Video::set_hiddenMode", D3DVideoObject_SetHiddenMode);
+    REG("D3D_Video::get_hiddenMode", D3DVideoObject_GetHiddenMode);
+    REG("D3D_Video::set_isRealTime", D3DVideoObject_SetRealTime);
+    REG("D3D_Video::get_isRealTime", D3DVideoObject_GetRealTime);
+    REG("D3D_Video::get_droppedFrames", D3DVideoObject_GetDroppedFrames);
+    REG("D3D_Video::get_lateFrames", D3DVideoObject_GetLateFrames);
 
     REG("D3D_Video::NextFrame^0", D3DVideoObject_NextFrame);
+    REG("D3D_Video::Seek^1", D3DVideoObject_Seek);
     REG("D3D_Video::Autoplay^0", D3DVideoObject_Autoplay);
     REG("D3D_Video::IsAutoplaying^0", D3DVideoObject_IsAutoplaying);
     REG("D3D_Video::StopAutoplay^0", D3DVideoObject_StopAutoplay);
+    REG("D3D_Video::IsLoading^0", D3DVideoObject_IsLoading);
 #endif // VIDEO_PLAYBACK
 
     REG("testCall", testCall);
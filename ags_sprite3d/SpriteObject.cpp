@@ -1,4 +1,5 @@
 #include "SpriteObject.h"
+#include "TextureCache.h"
 
 SpriteObject::SpriteObject()
 {
@@ -24,6 +25,8 @@ SpriteObject* SpriteObject::Open( char const* filename, Filtering filtering )
     obj->myType = TYPE_EXTERNAL;
     obj->myFiltering = filtering;
     obj->myFile = filename;
+    // Start decoding right away
+    obj->CreateTexture();
     return obj;
 }
 
@@ -52,6 +55,19 @@ int SpriteObject::GetHeight() const
     return myHeight;
 }
 
+bool SpriteObject::IsLoading()
+{
+    if ( myIsLoading && !TextureCache::IsLoading( myRender.get() ) )
+    {
+        myIsLoading = false;
+        myWidth = myRender->GetTexWidth();
+        myHeight = myRender->GetTexHeight();
+        SetDirty();
+        DBGF( "myRender loaded: %d x %d", myWidth, myHeight );
+    }
+    return myIsLoading;
+}
+
 void SpriteObject::Start()
 {
     if ( !myRender )
@@ -66,6 +82,10 @@ void SpriteObject::Update()
 
 void SpriteObject::Render()
 {
+    if ( IsLoading() )
+    {
+        return;
+    }
     // Render texture to screen
     BaseObject::RenderSelf();
 }
@@ -86,6 +106,7 @@ int SpriteObject::Serialize( char* buffer, int bufsize )
     SERIALIZE( texw );
     SERIALIZE( texh );
     SERIALIZE( texa );
+    buffer += SerializeExtras( buffer, bufsize - ( buffer - bufStart ) );
 
     return buffer - bufStart;
 }
@@ -104,6 +125,7 @@ int SpriteObject::Unserialize( char const* buffer, int size )
     UNSERIALIZE( texw );
     UNSERIALIZE( texh );
     UNSERIALIZE( texa );
+    buffer += UnserializeExtras( buffer, size - ( buffer - bufStart ) );
 
     // Load image and create texture
     CreateTexture();
@@ -113,30 +135,34 @@ int SpriteObject::Unserialize( char const* buffer, int size )
 
 void SpriteObject::CreateTexture()
 {
-    myRender = GetFactory()->CreateRenderObject();
+    // Objects opened from the same source share the texture
+    myRender.reset();
     if ( myType == TYPE_INTERNAL && mySpriteID >= 0 )
     {
         // Get sprite from AGS
         DBGF( "Creating texture from sprite: %d", mySpriteID );
-        myRender->CreateTexture(mySpriteID, -1, nullptr);
+        myRender = TextureCache::GetSprite( mySpriteID );
     }
     else if ( myType == TYPE_BACKGROUND && mySpriteID >= 0 )
     {
         // Get sprite from AGS background frame
         DBGF( "Creating texture from room background: %d", mySpriteID );
-        myRender->CreateTexture(-1, mySpriteID, nullptr);
+        myRender = TextureCache::GetBackground( mySpriteID );
     }
     else if ( myType == TYPE_EXTERNAL && !myFile.empty() )
     {
-        // Create from PNG data
+        // Create from PNG data, decoded in the background
         DBGF( "Creating texture from file: %s", myFile.c_str() );
-        myRender->CreateTexture(-1, -1, myFile.c_str());
+        myRender = TextureCache::GetFileAsync( myFile.c_str() );
     }
 
-    if (myRender)
+    // Size is known once the file has been decoded
+    myIsLoading = TextureCache::IsLoading( myRender.get() );
+    if (myRender && !myIsLoading)
     {
         myWidth = myRender->GetTexWidth();
         myHeight = myRender->GetTexHeight();
+        SetDirty();
         DBGF("myRender created: %d x %d", myWidth, myHeight);
     }
 }
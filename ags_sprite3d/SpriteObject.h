@@ -17,6 +17,8 @@ public:
 
     virtual int GetWidth() const;
     virtual int GetHeight() const;
+    // Tells if the image file is still being decoded
+    bool IsLoading();
 
     virtual void Start();
     virtual void Update();
@@ -38,6 +40,7 @@ private:
     SpriteType myType = TYPE_INTERNAL;
     int mySpriteID = 0;
     std::string myFile;
+    bool myIsLoading = false;
 };
 
 
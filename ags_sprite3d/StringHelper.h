@@ -1,7 +1,10 @@
 #ifndef SPRITE3D_STRINGHELPER_H
 #define SPRITE3D_STRINGHELPER_H
 
+#include <cctype>
+#include <cstdlib>
 #include <cstring>
+#include <string>
 #if !defined (WINDOWS_VERSION)
 #include <strings.h>
 #endif
@@ -16,4 +19,39 @@ inline int stricmp(const char* a, const char* b) { return strcasecmp(a, b); }
 
 inline const char* GetExt(const char* filename) { return strrchr(filename, '.'); }
 
+// Same file may be referred by different paths
+inline std::string GetCanonicalPath(const char* filename)
+{
+#if defined (WINDOWS_VERSION)
+    char buffer[MAX_PATH];
+    if (!_fullpath(buffer, filename, MAX_PATH))
+        return filename;
+    // Case insensitive file system
+    for (char* c = buffer; *c; ++c)
+        *c = (*c == '/') ? '\\' : static_cast<char>(tolower(*c));
+    return buffer;
+#else
+    char* path = realpath(filename, nullptr);
+    if (!path)
+    {
+        // File need not exist, such as the images packed into a container;
+        // resolve the folder it would be in
+        const char* slash = strrchr(filename, '/');
+        if (slash == filename)
+            return filename;
+        if (slash)
+            return GetCanonicalPath(std::string(filename, slash).c_str()) + slash;
+        path = realpath(".", nullptr);
+        if (!path)
+            return filename;
+        std::string result = std::string(path) + "/" + filename;
+        free(path);
+        return result;
+    }
+    std::string result = path;
+    free(path);
+    return result;
+#endif
+}
+
 #endif // SPRITE3D_STRINGHELPER_H
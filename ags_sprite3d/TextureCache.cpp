@@ -0,0 +1,176 @@
+#include "TextureCache.h"
+#include <string>
+#include "Common.h"
+#include "ImageLoader.h"
+#include "TextureContainer.h"
+#include "StringHelper.h"
+#include "TexturePrefetch.h"
+
+std::unordered_map< std::string, TextureCache::Entry > TextureCache::ourEntries;
+size_t TextureCache::ourPruneSize = TextureCache::MinPruneSize;
+std::unordered_map< std::string, std::weak_ptr< RenderObject > > TextureCache::ourLoading;
+
+template <typename TFunc>
+std::shared_ptr<RenderObject> TextureCache::Get( std::string const& key, Source const& source, TFunc create )
+{
+    auto it = ourEntries.find( key );
+    if ( it != ourEntries.end() && it->second.source == source )
+    {
+        if ( auto render = it->second.render.lock() )
+        {
+            return render;
+        }
+    }
+
+    std::shared_ptr<RenderObject> render = GetFactory()->CreateRenderObject();
+    create( render );
+    Entry& entry = ourEntries[key];
+    entry.render = render;
+    entry.source = source;
+    if ( ourEntries.size() >= ourPruneSize )
+    {
+        Prune();
+    }
+    return render;
+}
+
+void TextureCache::Prune()
+{
+    for ( auto i = ourEntries.begin(); i != ourEntries.end(); )
+    {
+        if ( i->second.render.expired() )
+            i = ourEntries.erase( i );
+        else
+            ++i;
+    }
+    // Next time when the live entries have doubled
+    ourPruneSize = ourEntries.size() * 2 < MinPruneSize ? MinPruneSize : ourEntries.size() * 2;
+}
+
+TextureCache::Source TextureCache::GetSource( BITMAP* bmp )
+{
+    Source source;
+    if ( !bmp )
+    {
+        return source;
+    }
+    GetAGS()->GetBitmapDimensions( bmp, &source.width, &source.height, &source.depth );
+
+    // Reading the pixels costs less than uploading them, which sharing saves
+    size_t pitch = static_cast<size_t>( source.width ) * ( ( source.depth + 7 ) / 8 );
+    unsigned char** rows = GetAGS()->GetRawBitmapSurface( bmp );
+    uint64_t hash = 14695981039346656037ull;
+    for ( int y = 0; y < source.height; ++y )
+    {
+        unsigned char const* row = rows[y];
+        size_t x = 0;
+        for ( ; x + sizeof( uint64_t ) <= pitch; x += sizeof( uint64_t ) )
+        {
+            uint64_t word;
+            memcpy( &word, row + x, sizeof( word ) );
+            hash = ( hash ^ word ) * 1099511628211ull;
+            hash ^= hash >> 32;
+        }
+        for ( ; x < pitch; ++x )
+        {
+            hash = ( hash ^ row[x] ) * 1099511628211ull;
+        }
+    }
+    GetAGS()->ReleaseBitmapSurface( bmp );
+    source.hash = hash;
+    return source;
+}
+
+std::string TextureCache::GetBackgroundKey( int frame )
+{
+    // Frame numbers are only unique within a room
+    return "background:" + std::to_string( GetAGS()->GetCurrentRoom() ) + ":" + std::to_string( frame );
+}
+
+std::shared_ptr<RenderObject> TextureCache::GetSprite( int spriteID )
+{
+    TexturePrefetch::RecordSprite( spriteID );
+    Source source = GetSource( GetAGS()->GetSpriteGraphic( spriteID ) );
+    return Get( "sprite:" + std::to_string( spriteID ), source, [spriteID]( std::shared_ptr<RenderObject> const& render )
+    {
+        render->CreateTexture( spriteID, -1, nullptr );
+    });
+}
+
+std::shared_ptr<RenderObject> TextureCache::GetBackground( int frame )
+{
+    TexturePrefetch::RecordBackground( frame );
+    Source source = GetSource( GetAGS()->GetBackgroundScene( frame ) );
+    return Get( GetBackgroundKey( frame ), source, [frame]( std::shared_ptr<RenderObject> const& render )
+    {
+        render->CreateTexture( -1, frame, nullptr );
+    });
+}
+
+std::shared_ptr<RenderObject> TextureCache::GetFile( char const* filename )
+{
+    TexturePrefetch::RecordFile( filename );
+    return Get( "file:" + GetCanonicalPath( filename ), Source(), [filename]( std::shared_ptr<RenderObject> const& render )
+    {
+        render->CreateTexture( -1, -1, filename );
+    });
+}
+
+std::shared_ptr<RenderObject> TextureCache::GetFileAsync( char const* filename )
+{
+    // Packed images need no decoding
+    unsigned char const* pixels;
+    ImageInfo info;
+    if ( TextureContainer::Find( filename, pixels, info ) )
+    {
+        return GetFile( filename );
+    }
+    TexturePrefetch::RecordFile( filename );
+    return Get( "file:" + GetCanonicalPath( filename ), Source(), [filename]( std::shared_ptr<RenderObject> const& render )
+    {
+        ourLoading[filename] = render;
+        ImageLoader::Request( filename );
+    });
+}
+
+bool TextureCache::IsLoading( RenderObject const* render )
+{
+    if ( !render )
+    {
+        return false;
+    }
+    for ( auto const& loading : ourLoading )
+    {
+        if ( loading.second.lock().get() == render )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void TextureCache::Update()
+{
+    ImageLoader::Image image;
+    while ( ImageLoader::PopCompleted( image ) )
+    {
+        auto it = ourLoading.find( image.Filename );
+        if ( it == ourLoading.end() )
+        {
+            continue;
+        }
+        // Objects may have been disposed of while the file was decoded
+        if ( auto render = it->second.lock() )
+        {
+            if ( image.IsValid )
+            {
+                render->CreateTexture( image.Filename.c_str(), image.Data, image.Info );
+            }
+            else
+            {
+                DBGF( "Could not create texture from file %s", image.Filename.c_str() );
+            }
+        }
+        ourLoading.erase( it );
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef SPRITE3D_TEXTURECACHE_H
+#define SPRITE3D_TEXTURECACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "Common.h"
+#include "RenderObject.h"
+
+// Render objects of the sprites, room backgrounds and image files in use.
+// All the objects opened from the same source share one render object,
+// which lives as long as any of them does. Sprites and backgrounds are
+// shared only while their pixels stay the same; once the script draws on
+// them, the next opening gets a new texture and the earlier ones keep theirs.
+class TextureCache
+{
+public:
+    static std::shared_ptr<RenderObject> GetSprite( int spriteID );
+    // Background frame of the current room
+    static std::shared_ptr<RenderObject> GetBackground( int frame );
+    static std::shared_ptr<RenderObject> GetFile( char const* filename );
+    // Same as GetFile, but the file is decoded in the background and the
+    // render object gets its texture in one of the next updates
+    static std::shared_ptr<RenderObject> GetFileAsync( char const* filename );
+    static bool IsLoading( RenderObject const* render );
+    // Creates textures of the files decoded since the last update;
+    // called once per frame before drawing
+    static void Update();
+
+private:
+    // Engine bitmap the texture was made of, with a hash of its pixels;
+    // any difference means the sprite was drawn on or replaced
+    struct Source
+    {
+        int width = 0;
+        int height = 0;
+        int depth = 0;
+        uint64_t hash = 0;
+
+        bool operator==( Source const& other ) const
+        {
+            return width == other.width && height == other.height && depth == other.depth && hash == other.hash;
+        }
+    };
+
+    struct Entry
+    {
+        std::weak_ptr< RenderObject > render;
+        Source source;
+    };
+
+    template <typename TFunc>
+    static std::shared_ptr<RenderObject> Get( std::string const& key, Source const& source, TFunc create );
+    static Source GetSource( BITMAP* bmp );
+    static std::string GetBackgroundKey( int frame );
+    // Forgets the sources no longer in use
+    static void Prune();
+
+    static const size_t MinPruneSize = 16;
+
+    static std::unordered_map< std::string, Entry > ourEntries;
+    static size_t ourPruneSize;
+    // Render objects waiting for their files to be decoded
+    static std::unordered_map< std::string, std::weak_ptr< RenderObject > > ourLoading;
+};
+
+#endif // SPRITE3D_TEXTURECACHE_H
@@ -0,0 +1,160 @@
+#include "TextureContainer.h"
+#include <algorithm>
+#include <cstring>
+#include "Common.h"
+#include "StringHelper.h"
+#if !defined (WINDOWS_VERSION)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace ContainerFormat;
+
+std::vector< TextureContainer::Mapping > TextureContainer::ourMappings;
+std::unordered_map< std::string, TextureContainer::Image > TextureContainer::ourImages;
+
+// Same file may be referred by different paths
+static std::string GetKey( std::string const& filename )
+{
+    std::string key = filename;
+#if !defined (WINDOWS_VERSION)
+    std::replace( key.begin(), key.end(), '\\', '/' );
+#endif
+    return GetCanonicalPath( key.c_str() );
+}
+
+static unsigned char const* MapFile( char const* filename, size_t& size )
+{
+#if defined (WINDOWS_VERSION)
+    HANDLE file = CreateFileA( filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+    if ( file == INVALID_HANDLE_VALUE )
+    {
+        return nullptr;
+    }
+    LARGE_INTEGER fileSize;
+    void* base = nullptr;
+    if ( GetFileSizeEx( file, &fileSize ) && fileSize.QuadPart > 0 )
+    {
+        HANDLE mapping = CreateFileMappingA( file, NULL, PAGE_READONLY, 0, 0, NULL );
+        if ( mapping )
+        {
+            // View stays valid after the handles are closed
+            base = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+            CloseHandle( mapping );
+        }
+        size = static_cast<size_t>( fileSize.QuadPart );
+    }
+    CloseHandle( file );
+    return static_cast<unsigned char const*>( base );
+#else
+    int fd = open( filename, O_RDONLY );
+    if ( fd < 0 )
+    {
+        return nullptr;
+    }
+    struct stat st;
+    void* base = MAP_FAILED;
+    if ( fstat( fd, &st ) == 0 && st.st_size > 0 )
+    {
+        // Mapping stays valid after the file is closed
+        size = static_cast<size_t>( st.st_size );
+        base = mmap( nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    }
+    close( fd );
+    return base != MAP_FAILED ? static_cast<unsigned char const*>( base ) : nullptr;
+#endif
+}
+
+static void UnmapFile( unsigned char const* base, size_t size )
+{
+#if defined (WINDOWS_VERSION)
+    UnmapViewOfFile( base );
+#else
+    munmap( const_cast<unsigned char*>( base ), size );
+#endif
+}
+
+bool TextureContainer::Mount( char const* filename )
+{
+    size_t size = 0;
+    unsigned char const* base = MapFile( filename, size );
+    if ( !base )
+    {
+        DBGF( "Could not map texture container %s", filename );
+        return false;
+    }
+
+    ContainerHeader header;
+    bool valid = size >= sizeof( header );
+    if ( valid )
+    {
+        memcpy( &header, base, sizeof( header ) );
+        valid = memcmp( header.magic, Magic, sizeof( Magic ) ) == 0 && header.version == Version &&
+            header.indexOffset <= size && ( size - header.indexOffset ) / sizeof( ContainerEntry ) >= header.count;
+    }
+    if ( !valid )
+    {
+        DBGF( "Not a valid texture container %s", filename );
+        UnmapFile( base, size );
+        return false;
+    }
+
+    // Entry names are relative to the folder of the container
+    std::string folder = filename;
+    folder.erase( folder.find_last_of( "/\\" ) + 1 );
+
+    for ( uint32_t n = 0; n < header.count; ++n )
+    {
+        // Index offset comes from the file and may be misaligned
+        ContainerEntry entry;
+        memcpy( &entry, base + header.indexOffset + n * sizeof( entry ), sizeof( entry ) );
+        uint64_t dataSize = static_cast<uint64_t>( entry.width ) * entry.height * 4;
+        if ( entry.nameOffset >= size || !memchr( base + entry.nameOffset, 0, size - entry.nameOffset ) ||
+            entry.format != FORMAT_BGRA8 || entry.width == 0 || entry.height == 0 ||
+            entry.dataOffset > size || size - entry.dataOffset < dataSize )
+        {
+            DBGF( "Skipping invalid entry #%u in texture container %s", n, filename );
+            continue;
+        }
+
+        Image image;
+        image.pixels = base + entry.dataOffset;
+        image.info.Width = entry.width;
+        image.info.Height = entry.height;
+        image.info.BPP = 4;
+        image.info.HasAlpha = ( entry.flags & FLAG_ALPHA ) != 0;
+        ourImages[GetKey( folder + reinterpret_cast<char const*>( base + entry.nameOffset ) )] = image;
+    }
+
+    ourMappings.push_back( Mapping{ base, size } );
+    DBGF( "Mounted texture container %s: %u images", filename, header.count );
+    return true;
+}
+
+void TextureContainer::UnmountAll()
+{
+    ourImages.clear();
+    for ( auto const& mapping : ourMappings )
+    {
+        UnmapFile( mapping.base, mapping.size );
+    }
+    ourMappings.clear();
+}
+
+bool TextureContainer::Find( char const* filename, unsigned char const*& pixels, ImageInfo& info )
+{
+    if ( ourImages.empty() )
+    {
+        return false;
+    }
+    auto it = ourImages.find( GetKey( filename ) );
+    if ( it == ourImages.end() )
+    {
+        return false;
+    }
+    pixels = it->second.pixels;
+    info = it->second.info;
+    return true;
+}
@@ -0,0 +1,86 @@
+#ifndef SPRITE3D_TEXTURECONTAINER_H
+#define SPRITE3D_TEXTURECONTAINER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ImageHelper.h"
+
+// Texture container is a file of images packed in the layout they are
+// uploaded in, made with the s3dtpack tool. Mounted containers are mapped
+// to memory, and the images found in them are uploaded straight from the
+// mapping instead of decoding the original files.
+//
+// File layout, numbers are little endian:
+//   ContainerHeader
+//   ContainerEntry[count] at indexOffset
+//   entry names, zero terminated, at nameOffset
+//   entry pixels at dataOffset, aligned to 16 bytes
+namespace ContainerFormat
+{
+    const char Magic[4] = { 'S', '3', 'D', 'T' };
+    const uint32_t Version = 1;
+    const size_t DataAlignment = 16;
+
+    enum PixelFormat
+    {
+        FORMAT_BGRA8 = 0 // rows of width * 4 bytes, top to bottom
+    };
+
+    enum EntryFlags
+    {
+        FLAG_ALPHA = 0x1
+    };
+
+    struct ContainerHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t count;
+        uint32_t reserved;
+        uint64_t indexOffset;
+    };
+
+    struct ContainerEntry
+    {
+        uint64_t dataOffset;
+        uint32_t nameOffset;
+        uint32_t width;
+        uint32_t height;
+        uint32_t format;
+        uint32_t flags;
+        uint32_t reserved;
+    };
+}
+
+class TextureContainer
+{
+public:
+    // Makes the images in the container override the files of the same path,
+    // relative to the container's folder; later containers override earlier
+    static bool Mount( char const* filename );
+    static void UnmountAll();
+
+    // Pixels of the file packed into a mounted container, valid until unmounted
+    static bool Find( char const* filename, unsigned char const*& pixels, ImageInfo& info );
+
+private:
+    struct Mapping
+    {
+        unsigned char const* base;
+        size_t size;
+    };
+
+    struct Image
+    {
+        unsigned char const* pixels;
+        ImageInfo info;
+    };
+
+    static std::vector< Mapping > ourMappings;
+    static std::unordered_map< std::string, Image > ourImages;
+};
+
+#endif // SPRITE3D_TEXTURECONTAINER_H
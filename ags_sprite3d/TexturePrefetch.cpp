@@ -0,0 +1,243 @@
+#include "TexturePrefetch.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include "Common.h"
+#include "StringHelper.h"
+#include "TextureCache.h"
+
+// Time spent on the queued prefetches in one frame, in seconds
+static const float MaxFrameTime = 0.004f;
+
+TexturePrefetch::Mode TexturePrefetch::ourMode = TexturePrefetch::MODE_OFF;
+std::string TexturePrefetch::ourFilename;
+std::map< int, std::set< std::string > > TexturePrefetch::ourManifest;
+bool TexturePrefetch::ourIsChanged = false;
+int TexturePrefetch::ourRoom = -1;
+std::vector< std::string > TexturePrefetch::ourQueue;
+int TexturePrefetch::ourQueueRoom = -1;
+std::map< int, std::vector< std::shared_ptr< RenderObject > > > TexturePrefetch::ourHeld;
+
+void TexturePrefetch::SetMode( char const* filename, Mode mode )
+{
+    CleanUp();
+    ourMode = mode;
+    ourFilename = filename ? filename : "";
+    if ( ourMode != MODE_OFF && !ourFilename.empty() && !Read() && ourMode == MODE_PLAY )
+    {
+        DBGF( "Could not read prefetch manifest %s", ourFilename.c_str() );
+        ourMode = MODE_OFF;
+    }
+    // Current room is handled on the next update, as if it was just entered
+    ourRoom = -1;
+}
+
+void TexturePrefetch::CleanUp()
+{
+    if ( ourMode == MODE_RECORD && ourIsChanged )
+    {
+        Write();
+    }
+    ourManifest.clear();
+    ourIsChanged = false;
+    ourQueue.clear();
+    ourHeld.clear();
+}
+
+void TexturePrefetch::RecordSprite( int spriteID )
+{
+    if ( ourMode == MODE_RECORD )
+    {
+        Record( "sprite " + std::to_string( spriteID ) );
+    }
+}
+
+void TexturePrefetch::RecordBackground( int frame )
+{
+    if ( ourMode == MODE_RECORD )
+    {
+        Record( "background " + std::to_string( frame ) );
+    }
+}
+
+void TexturePrefetch::RecordFile( char const* filename )
+{
+    if ( ourMode != MODE_RECORD )
+    {
+        return;
+    }
+    // Files are opened from the compiled folder, which moves with the game
+    char folder[MAX_PATH];
+    GetAGS()->GetPathToFileInCompiledFolder( "", folder );
+    size_t len = strlen( folder );
+    if ( strncmp( filename, folder, len ) == 0 )
+    {
+        filename += len;
+    }
+    Record( std::string( "file " ) + filename );
+}
+
+void TexturePrefetch::Record( std::string const& entry )
+{
+    if ( ourManifest[GetAGS()->GetCurrentRoom()].insert( entry ).second )
+    {
+        ourIsChanged = true;
+    }
+}
+
+void TexturePrefetch::PrefetchRoom( int room )
+{
+    if ( ourMode != MODE_PLAY )
+    {
+        return;
+    }
+    ourQueue.clear();
+    ourQueueRoom = room;
+    auto it = ourManifest.find( room );
+    if ( it != ourManifest.end() )
+    {
+        // Taken from the back, keep the manifest order
+        ourQueue.assign( it->second.rbegin(), it->second.rend() );
+    }
+}
+
+void TexturePrefetch::EnterRoom()
+{
+    int room = GetAGS()->GetCurrentRoom();
+    if ( ourMode == MODE_OFF || room == ourRoom )
+    {
+        return;
+    }
+
+    ourRoom = room;
+    if ( ourMode == MODE_RECORD )
+    {
+        // Keep the manifest in case the game does not exit cleanly
+        if ( ourIsChanged )
+        {
+            Write();
+            ourIsChanged = false;
+        }
+        return;
+    }
+
+    // Everything the room needs is created before it is drawn; textures
+    // prefetched for the other rooms are released unless in use or queued
+    std::vector< std::shared_ptr< RenderObject > > held;
+    auto it = ourManifest.find( room );
+    if ( it != ourManifest.end() )
+    {
+        for ( auto const& entry : it->second )
+        {
+            if ( auto render = Load( entry, true ) )
+            {
+                held.push_back( render );
+            }
+        }
+    }
+    if ( ourQueueRoom == room )
+    {
+        ourQueue.clear();
+    }
+    for ( auto i = ourHeld.begin(); i != ourHeld.end(); )
+    {
+        if ( i->first != ourQueueRoom || ourQueue.empty() )
+            i = ourHeld.erase( i );
+        else
+            ++i;
+    }
+    ourHeld[room].swap( held );
+}
+
+void TexturePrefetch::Update()
+{
+    // Normally done already, unless the device was not ready at the time
+    EnterRoom();
+
+    if ( ourMode != MODE_PLAY || ourQueue.empty() )
+    {
+        return;
+    }
+
+    // Spread the work over frames, so that the current room keeps playing
+    auto start = std::chrono::steady_clock::now();
+    auto& held = ourHeld[ourQueueRoom];
+    do
+    {
+        if ( auto render = Load( ourQueue.back(), false ) )
+        {
+            held.push_back( render );
+        }
+        ourQueue.pop_back();
+    }
+    while ( !ourQueue.empty() &&
+        std::chrono::duration<float>( std::chrono::steady_clock::now() - start ).count() < MaxFrameTime );
+}
+
+std::shared_ptr<RenderObject> TexturePrefetch::Load( std::string const& entry, bool isEntered )
+{
+    int value;
+    if ( sscanf( entry.c_str(), "sprite %d", &value ) == 1 )
+    {
+        // Dynamic sprite recorded in another run may not exist by now
+        return GetAGS()->GetSpriteGraphic( value ) ? TextureCache::GetSprite( value ) : nullptr;
+    }
+    if ( sscanf( entry.c_str(), "background %d", &value ) == 1 )
+    {
+        return isEntered ? TextureCache::GetBackground( value ) : nullptr;
+    }
+    if ( entry.compare( 0, 5, "file " ) == 0 )
+    {
+        char buffer[MAX_PATH];
+        GetAGS()->GetPathToFileInCompiledFolder( entry.c_str() + 5, buffer );
+        return isEntered ? TextureCache::GetFile( buffer ) : TextureCache::GetFileAsync( buffer );
+    }
+    DBGF( "Unknown prefetch entry: %s", entry.c_str() );
+    return nullptr;
+}
+
+bool TexturePrefetch::Read()
+{
+    FILE* file = fopen( ourFilename.c_str(), "r" );
+    if ( !file )
+    {
+        return false;
+    }
+
+    int room = -1;
+    char line[MAX_PATH + 16];
+    while ( fgets( line, sizeof( line ), file ) )
+    {
+        line[strcspn( line, "\r\n" )] = '\0';
+        if ( !line[0] )
+        {
+            continue;
+        }
+        if ( sscanf( line, "room %d", &room ) != 1 )
+        {
+            ourManifest[room].insert( line );
+        }
+    }
+    fclose( file );
+    return true;
+}
+
+void TexturePrefetch::Write()
+{
+    FILE* file = fopen( ourFilename.c_str(), "w" );
+    if ( !file )
+    {
+        DBGF( "Could not write prefetch manifest %s", ourFilename.c_str() );
+        return;
+    }
+
+    for ( auto const& room : ourManifest )
+    {
+        fprintf( file, "room %d\n", room.first );
+        for ( auto const& entry : room.second )
+        {
+            fprintf( file, "%s\n", entry.c_str() );
+        }
+    }
+    fclose( file );
+}
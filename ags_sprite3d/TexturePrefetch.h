@@ -0,0 +1,65 @@
+#ifndef SPRITE3D_TEXTUREPREFETCH_H
+#define SPRITE3D_TEXTUREPREFETCH_H
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include "RenderObject.h"
+
+// Lists of the textures used in each room, so that they could be created
+// before the room is drawn instead of on the first draw of their owners.
+// Manifest is a text file, with lines like "room 2", "sprite 15",
+// "background 0" and "file images/sky.png" under each room.
+class TexturePrefetch
+{
+public:
+    enum Mode
+    {
+        MODE_OFF    = 0,
+        MODE_RECORD = 1, // collect the textures used in rooms into the manifest
+        MODE_PLAY   = 2  // create the textures listed in the manifest ahead
+    };
+
+    // Filename is the full path to the manifest
+    static void SetMode( char const* filename, Mode mode );
+    // Writes the recorded manifest
+    static void CleanUp();
+
+    // Called by TextureCache for every texture used
+    static void RecordSprite( int spriteID );
+    static void RecordBackground( int frame );
+    static void RecordFile( char const* filename );
+
+    // Queues the sprites and files of the room to be created over the next
+    // frames; backgrounds can only be read once in that room
+    static void PrefetchRoom( int room );
+    // Creates everything listed for the room when it is entered; called
+    // before the objects are updated, as long as the device is ready
+    static void EnterRoom();
+    // Same as EnterRoom, and continues the queued prefetches; called once
+    // per frame before drawing
+    static void Update();
+
+private:
+    // Entry line without the room, creates its texture; backgrounds are only
+    // read in their room, files of other rooms are decoded in the background
+    static std::shared_ptr<RenderObject> Load( std::string const& entry, bool isEntered );
+    static void Record( std::string const& entry );
+    static bool Read();
+    static void Write();
+
+    static Mode ourMode;
+    static std::string ourFilename;
+    static std::map< int, std::set< std::string > > ourManifest;
+    static bool ourIsChanged;
+    static int ourRoom;
+    // Entries waiting to be created, for the given room
+    static std::vector< std::string > ourQueue;
+    static int ourQueueRoom;
+    // Holds the prefetched textures of each room until another room is entered
+    static std::map< int, std::vector< std::shared_ptr< RenderObject > > > ourHeld;
+};
+
+#endif // SPRITE3D_TEXTUREPREFETCH_H
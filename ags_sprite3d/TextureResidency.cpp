@@ -0,0 +1,91 @@
+#include "TextureResidency.h"
+#include "Common.h"
+
+std::list< TextureResidency::Entry > TextureResidency::ourEntries;
+std::unordered_map< RenderObject*, std::list< TextureResidency::Entry >::iterator > TextureResidency::ourLookup;
+size_t TextureResidency::ourBudget = 0;
+size_t TextureResidency::ourResidentBytes = 0;
+unsigned TextureResidency::ourFrame = 0;
+
+void TextureResidency::SetBudget( size_t bytes )
+{
+    ourBudget = bytes;
+}
+
+size_t TextureResidency::GetBudget()
+{
+    return ourBudget;
+}
+
+size_t TextureResidency::GetResidentBytes()
+{
+    return ourResidentBytes;
+}
+
+void TextureResidency::Touch( RenderObject* render )
+{
+    size_t size = render->GetMemorySize();
+    auto it = ourLookup.find( render );
+    if ( it != ourLookup.end() && size == 0 )
+    {
+        Remove( render );
+    }
+    else if ( it != ourLookup.end() )
+    {
+        // Size changes if texture was created again
+        ourResidentBytes += size - it->second->size;
+        it->second->size = size;
+        it->second->frame = ourFrame;
+        ourEntries.splice( ourEntries.end(), ourEntries, it->second );
+    }
+    else if ( size > 0 )
+    {
+        ourResidentBytes += size;
+        ourEntries.push_back( Entry{ render, size, ourFrame } );
+        ourLookup[render] = std::prev( ourEntries.end() );
+    }
+}
+
+void TextureResidency::Evict( RenderObject* render )
+{
+    if ( !render->GetMemorySize() )
+    {
+        return;
+    }
+    Remove( render );
+    render->Evict();
+}
+
+void TextureResidency::Remove( RenderObject* render )
+{
+    auto it = ourLookup.find( render );
+    if ( it == ourLookup.end() )
+    {
+        return;
+    }
+    ourResidentBytes -= it->second->size;
+    ourEntries.erase( it->second );
+    ourLookup.erase( it );
+}
+
+void TextureResidency::Trim()
+{
+    int room = GetAGS()->GetCurrentRoom();
+    for ( auto it = ourEntries.begin(); ourBudget > 0 && ourResidentBytes > ourBudget && it != ourEntries.end(); )
+    {
+        // The rest were drawn in the last frame too
+        if ( it->frame == ourFrame )
+        {
+            break;
+        }
+        RenderObject* render = it->render;
+        ++it;
+        // Backgrounds of other rooms could not be read back from here
+        int sourceRoom = render->GetSourceRoom();
+        if ( sourceRoom < 0 || sourceRoom == room )
+        {
+            Evict( render );
+        }
+    }
+    ++ourFrame;
+}
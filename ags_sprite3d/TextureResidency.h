@@ -0,0 +1,46 @@
+#ifndef SPRITE3D_TEXTURERESIDENCY_H
+#define SPRITE3D_TEXTURERESIDENCY_H
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include "RenderObject.h"
+
+// Keeps the memory of the drawn textures within a budget, by evicting
+// the ones which were not drawn for the longest time. Evicted render
+// objects create their textures again when drawn next time. Only the
+// textures of image files and room backgrounds are counted.
+class TextureResidency
+{
+public:
+    // Budget in bytes, 0 for no limit
+    static void SetBudget( size_t bytes );
+    static size_t GetBudget();
+    static size_t GetResidentBytes();
+
+    // Marks render object as drawn this frame
+    static void Touch( RenderObject* render );
+    static void Evict( RenderObject* render );
+    // Forgets the render object, it is being destroyed
+    static void Remove( RenderObject* render );
+    // Evicts textures not drawn this frame until within the budget;
+    // called once per frame
+    static void Trim();
+
+private:
+    struct Entry
+    {
+        RenderObject* render;
+        size_t size;
+        unsigned frame;
+    };
+
+    // Least recently drawn first
+    static std::list< Entry > ourEntries;
+    static std::unordered_map< RenderObject*, std::list< Entry >::iterator > ourLookup;
+    static size_t ourBudget;
+    static size_t ourResidentBytes;
+    static unsigned ourFrame;
+};
+
+#endif // SPRITE3D_TEXTURERESIDENCY_H
@@ -1,15 +1,23 @@
 #if defined (VIDEO_PLAYBACK)
 
 #include "VideoObject.h"
+#include <algorithm>
+#include <cmath>
+
+// Longest real time step, so that stalls like loading a save do not fast forward videos
+static const float MaxTimeStep = 0.25f;
 
 // Static variables
 std::unique_ptr<TheoraVideoManager> VideoObject::videoManager;
+bool VideoObject::yuvOutput = false;
+int VideoObject::decodeThreads = 1;
+int VideoObject::defaultPrecache = 0;
 
 
 void VideoObject::Initialize()
 {
     DBG( "Initializing VideoObject" );
-    videoManager.reset(new TheoraVideoManager());
+    videoManager.reset(new TheoraVideoManager( decodeThreads ));
 }
 
 void VideoObject::CleanUp()
@@ -18,12 +26,46 @@ void VideoObject::CleanUp()
     videoManager.reset();
 }
 
+void VideoObject::SetYUVOutput( bool enabled )
+{
+    yuvOutput = enabled;
+}
+
+void VideoObject::SetDecodeThreads( int count )
+{
+    decodeThreads = count < 1 ? 1 : count;
+    if ( videoManager )
+    {
+        videoManager->setNumWorkerThreads( decodeThreads );
+    }
+}
+
+int VideoObject::GetDecodeThreads()
+{
+    return decodeThreads;
+}
+
+void VideoObject::SetDefaultPrecache( int frames )
+{
+    defaultPrecache = frames < 0 ? 0 : frames;
+}
+
+TheoraOutputMode VideoObject::GetOutputMode()
+{
+    // Decode threads then only copy the planes, without converting colors
+    if ( yuvOutput && GetFactory()->IsYUVSupported() )
+        return TH_YUV;
+    return TH_BGRX;
+}
+
 VideoObject* VideoObject::Open( char const* filename )
 {
     VideoObject* obj = new VideoObject();
+    TheoraOutputMode mode = GetOutputMode();
+    obj->myIsYUV = mode == TH_YUV;
 	try
 	{
-		obj->myClip = videoManager->createVideoClip( filename, TH_BGRX );
+		obj->myClip = videoManager->createVideoClip( filename, mode, defaultPrecache );
 	}
 	catch (...)
 	{
@@ -39,9 +81,9 @@ VideoObject* VideoObject::Open( char const* filename )
     // No looping by default
     obj->myClip->setAutoRestart( false );
 
-    // Wait until frame cache is filled
-    while ( obj->myClip->getNumReadyFrames() != obj->myClip->getNumPrecachedFrames() );
-    
+    // Frames are decoded in the background, see Update
+    obj->myIsLoading = true;
+
 	obj->myWidth = obj->myClip->getWidth();
 	obj->myHeight = obj->myClip->getHeight();
 
@@ -114,6 +156,17 @@ bool VideoObject::NextFrame()
     return !myClip->isDone();
 }
 
+void VideoObject::Seek( float time )
+{
+    if ( !myClip ) return;
+
+    myHiddenTime = 0.f;
+    myIsHiddenPaused = false;
+    myClip->seek( std::max( time, 0.f ) );
+    // New frame is shown once decoded, see Update
+    myIsLoading = true;
+}
+
 void VideoObject::Autoplay()
 {
     myIsAutoplaying = true;
@@ -129,6 +182,80 @@ void VideoObject::StopAutoplay()
     myIsAutoplaying = false;
 }
 
+bool VideoObject::IsLoading() const
+{
+    return myIsLoading;
+}
+
+void VideoObject::SetPrecachedFrames( int frames )
+{
+    if ( !myClip || frames < 1 ) return;
+
+    myClip->setNumPrecachedFrames( frames );
+}
+
+int VideoObject::GetPrecachedFrames() const
+{
+    if ( !myClip ) return 0;
+
+    return myClip->getNumPrecachedFrames();
+}
+
+void VideoObject::SetDecodePriority( float priority )
+{
+    if ( !myClip ) return;
+
+    myClip->setPriority( priority );
+}
+
+float VideoObject::GetDecodePriority() const
+{
+    if ( !myClip ) return 0.f;
+
+    return myClip->getPriority();
+}
+
+int VideoObject::GetReadyFrames() const
+{
+    if ( !myClip ) return 0;
+
+    return myClip->getNumReadyFrames();
+}
+
+void VideoObject::SetHiddenMode( HiddenMode mode )
+{
+    myHiddenMode = mode;
+}
+
+VideoObject::HiddenMode VideoObject::GetHiddenMode() const
+{
+    return myHiddenMode;
+}
+
+void VideoObject::SetRealTime( bool enabled )
+{
+    myIsRealTime = enabled;
+    myHasTick = false;
+}
+
+bool VideoObject::IsRealTime() const
+{
+    return myIsRealTime;
+}
+
+int VideoObject::GetDroppedFrames() const
+{
+    if ( !myClip ) return myDroppedFrames;
+
+    // Including the frames which the decoder found outdated itself
+    return myDroppedFrames + myClip->getNumDroppedFrames();
+}
+
+int VideoObject::GetLateFrames() const
+{
+    return myLateFrames;
+}
+
 int VideoObject::GetWidth() const
 {
     if ( !myClip ) return 0;
@@ -157,16 +284,85 @@ void VideoObject::Update()
 {
     if ( !myClip ) return;
 
+    if ( myIsLoading )
+    {
+        // Hold playback until the first frame is decoded
+        myHasTick = false;
+        UpdateTexture();
+        return;
+    }
+
+    float timeStep = GetTimeStep();
+    bool hidden = myHiddenMode != HIDDEN_UPDATE && IsOutOfSight();
+    if ( hidden && myHiddenMode == HIDDEN_PAUSE )
+    {
+        // Clip is not advanced, so the decoder stops once its cache is full
+        if ( myIsAutoplaying )
+        {
+            myHiddenTime += timeStep * myClip->getPlaybackSpeed();
+        }
+        myIsHiddenPaused = true;
+        return;
+    }
+    if ( myIsHiddenPaused )
+    {
+        CatchUp();
+        return;
+    }
+
     if ( myIsAutoplaying )
     {
         // Autoplay video
-        myClip->update( GetScreen()->frameDelay );
+        myClip->update( timeStep );
+    }
+
+    if ( hidden )
+    {
+        // Drop the due frame without uploading it, so that decoding goes on
+        if ( myClip->getNextFrame() )
+        {
+            myClip->popFrame();
+        }
+        return;
     }
 
     // Change texture if frame has changed
     UpdateTexture();
 }
 
+float VideoObject::GetTimeStep()
+{
+    if ( !myIsRealTime ) return GetScreen()->frameDelay;
+
+    auto now = std::chrono::steady_clock::now();
+    float step = GetScreen()->frameDelay;
+    if ( myHasTick )
+    {
+        step = std::min( std::chrono::duration<float>( now - myLastTick ).count(), MaxTimeStep );
+    }
+    myLastTick = now;
+    myHasTick = true;
+    return step;
+}
+
+void VideoObject::CatchUp()
+{
+    myIsHiddenPaused = false;
+    if ( myHiddenTime <= 0.f ) return;
+
+    float time = myClip->getTimePosition() + myHiddenTime;
+    float duration = myClip->getDuration();
+    if ( duration > 0.f && time >= duration )
+    {
+        time = myClip->getAutoRestart() ? fmod( time, duration ) : duration;
+    }
+    myHiddenTime = 0.f;
+
+    // Last shown frame stays until the new one is decoded
+    myClip->seek( time );
+    myIsLoading = true;
+}
+
 void VideoObject::Render()
 {
     if ( !myClip ) return;
@@ -182,16 +378,37 @@ int VideoObject::Serialize( char* buffer, int bufsize )
     int num = BaseObject::Serialize( buffer, bufsize );
     buffer += num;
     
-    SERIALIZE_STR( myClip->getName() );
-    float time = myClip->getTimePosition();
+    // Clip which failed to load is saved without a name and skipped on restore
+    std::string filename;
+    float time = 0.f;
+    float speed = 1.f;
+    bool loop = false;
+    int precached = defaultPrecache;
+    float priority = 1.f;
+    if ( myClip )
+    {
+        filename = myClip->getName();
+        time = myClip->getTimePosition() + myHiddenTime;
+        speed = myClip->getPlaybackSpeed();
+        loop = myClip->getAutoRestart();
+        precached = myClip->getNumPrecachedFrames();
+        priority = myClip->getPriority();
+    }
+
+    SERIALIZE_STR( filename );
     SERIALIZE( time );
-    float speed = myClip->getPlaybackSpeed();
     SERIALIZE( speed );
-    bool loop = myClip->getAutoRestart();
     SERIALIZE( loop );
     SERIALIZE( myIsAutoplaying );
     int dummy = 0;
     SERIALIZE(dummy);
+    buffer += SerializeExtras( buffer, bufsize - ( buffer - bufStart ) );
+    int videoVersion = 3;
+    SERIALIZE( videoVersion );
+    SERIALIZE( precached );
+    SERIALIZE( priority );
+    SERIALIZE( myHiddenMode );
+    SERIALIZE( myIsRealTime );
 
     return buffer - bufStart;
 }
@@ -214,9 +431,43 @@ int VideoObject::Unserialize( char const* buffer, int size )
     UNSERIALIZE( myIsAutoplaying );
     int dummy;
     UNSERIALIZE( dummy );
+    buffer += UnserializeExtras( buffer, size - ( buffer - bufStart ) );
+    // Decoding settings, absent in older saves
+    int videoVersion = 0;
+    if ( size - ( buffer - bufStart ) >= static_cast<int>( sizeof( videoVersion ) ) )
+    {
+        UNSERIALIZE( videoVersion );
+    }
+    int precached = defaultPrecache;
+    float priority = 1.f;
+    if ( videoVersion >= 1 )
+    {
+        UNSERIALIZE( precached );
+        UNSERIALIZE( priority );
+    }
+    if ( videoVersion >= 2 )
+    {
+        UNSERIALIZE( myHiddenMode );
+    }
+    if ( videoVersion >= 3 )
+    {
+        UNSERIALIZE( myIsRealTime );
+    }
 
     // Load video
-    myClip = videoManager->createVideoClip( filename, TH_BGRA );
+    TheoraOutputMode mode = GetOutputMode();
+    myIsYUV = mode == TH_YUV;
+    if ( !filename.empty() )
+    {
+        try
+        {
+            myClip = videoManager->createVideoClip( filename, mode, precached );
+        }
+        catch (...)
+        {
+            DBGF( "File could not be opened: %s", filename.c_str() );
+        }
+    }
 
     if ( !myClip )
     {
@@ -227,11 +478,11 @@ int VideoObject::Unserialize( char const* buffer, int size )
         // Set video properties
         myClip->setAutoRestart( loop );
         myClip->setPlaybackSpeed( speed );
+        myClip->setPriority( priority );
         myClip->seek( time );
 
-        // Wait until frame cache is filled
-        while ( myClip->getNumReadyFrames() != myClip->getNumPrecachedFrames() );
-
+        // Nothing is drawn until the frame we seeked to is decoded
+        myIsLoading = true;
         UpdateTexture();
     }
 
@@ -244,14 +495,36 @@ void VideoObject::UpdateTexture()
 
     TheoraVideoFrame* frame = myClip->getNextFrame();
 
+    if ( frame && myIsRealTime )
+    {
+        // When behind by more than a frame, go to the newest ready frame
+        // instead of uploading every one of them
+        float frameTime = 1.f / myClip->getFps();
+        float time = myClip->getTimePosition();
+        while ( frame && time - frame->mTimeToDisplay > frameTime && myClip->getNumReadyFrames() > 1 )
+        {
+            myClip->popFrame();
+            ++myDroppedFrames;
+            frame = myClip->getNextFrame();
+        }
+        if ( frame && time - frame->mTimeToDisplay > frameTime )
+        {
+            ++myLateFrames;
+        }
+    }
+
     if ( frame )
     {
         // New frame, let's update the texture
         if (!myRender)
             myRender = GetFactory()->CreateRenderObject();
-        myRender->CreateTexture(frame->getBuffer(), frame->getWidth(), frame->getHeight(), frame->bpp);
+        if ( myIsYUV )
+            myRender->CreateYUVTexture( frame->getBuffer(), frame->getWidth(), frame->getHeight() );
+        else
+            myRender->CreateTexture(frame->getBuffer(), frame->getWidth(), frame->getHeight(), frame->bpp);
         // Pop frame from queue
         myClip->popFrame();
+        myIsLoading = false;
     }
 }
 
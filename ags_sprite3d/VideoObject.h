@@ -3,6 +3,7 @@
 
 #if defined (VIDEO_PLAYBACK)
 
+#include <chrono>
 #include <memory>
 #include <theoraplayer/TheoraPlayer.h>
 #include "BaseObject.h"
@@ -11,11 +12,26 @@
 class VideoObject : public BaseObject
 {
 public:
+    // What to do while the object is out of sight, see BaseObject::IsOutOfSight
+    enum HiddenMode
+    {
+        HIDDEN_UPDATE       = 0, // same as when visible
+        HIDDEN_SKIP_UPLOAD  = 1, // keep decoding, but do not update the texture
+        HIDDEN_PAUSE        = 2  // stop decoding too, seek forward when shown again
+    };
+
     static void Initialize();
     static void CleanUp();
 
     static VideoObject* Open( char const* filename );
     static VideoObject* Restore( char const* buffer, int size );
+    // Makes videos opened afterwards decode to YUV, converted by the renderer
+    static void SetYUVOutput( bool enabled );
+    // Number of threads decoding all the clips
+    static void SetDecodeThreads( int count );
+    static int GetDecodeThreads();
+    // Frames decoded ahead for videos opened afterwards, 0 for the default
+    static void SetDefaultPrecache( int frames );
 
     virtual ~VideoObject();
     
@@ -24,9 +40,30 @@ public:
     void SetFPS( float fps );
     float GetFPS() const;
     bool NextFrame();
+    // Jumps to the last keyframe at or before the time, in seconds
+    void Seek( float time );
     void Autoplay();
     bool IsAutoplaying() const;
     void StopAutoplay();
+    // Tells if the clip is still decoding its first frame
+    bool IsLoading() const;
+    // Frames decoded ahead for this clip
+    void SetPrecachedFrames( int frames );
+    int GetPrecachedFrames() const;
+    // Clips with higher priority get more decoding time
+    void SetDecodePriority( float priority );
+    float GetDecodePriority() const;
+    // Decoded frames waiting to be shown
+    int GetReadyFrames() const;
+    void SetHiddenMode( HiddenMode mode );
+    HiddenMode GetHiddenMode() const;
+    // Plays by the real time passed, instead of the game speed
+    void SetRealTime( bool enabled );
+    bool IsRealTime() const;
+    // Frames left out because decoding or drawing fell behind
+    int GetDroppedFrames() const;
+    // Frames shown later than their time
+    int GetLateFrames() const;
     virtual int GetWidth() const;
     virtual int GetHeight() const;
     virtual void Start();
@@ -39,11 +76,31 @@ public:
 private:
     VideoObject();
     void UpdateTexture();
+    // Seeks to where the playback would be if it was not paused while hidden
+    void CatchUp();
+    // Playback time to advance by this update
+    float GetTimeStep();
+    static TheoraOutputMode GetOutputMode();
 
     static std::unique_ptr<TheoraVideoManager> VideoObject::videoManager;
+    static bool yuvOutput;
+    static int decodeThreads;
+    static int defaultPrecache;
 
     TheoraVideoClip* myClip = nullptr; // created & destroyed via an interface
     bool myIsAutoplaying = false;
+    bool myIsYUV = false;
+    bool myIsLoading = false;
+    HiddenMode myHiddenMode = HIDDEN_UPDATE; // others are opted into by script
+    // Playback time passed while paused out of sight
+    float myHiddenTime = 0.f;
+    bool myIsHiddenPaused = false;
+    bool myIsRealTime = false;
+    // Time of the last update in the real time mode, if there was one
+    std::chrono::steady_clock::time_point myLastTick;
+    bool myHasTick = false;
+    int myDroppedFrames = 0;
+    int myLateFrames = 0;
 };
 
 
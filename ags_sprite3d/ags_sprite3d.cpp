@@ -3,7 +3,11 @@
 #include <string>
 #include "Common.h"
 #include "BaseObject.h"
+#include "ImageLoader.h"
 #include "StringHelper.h"
+#include "TextureCache.h"
+#include "TextureContainer.h"
+#include "TexturePrefetch.h"
 #include "VideoObject.h"
 
 // Sprite3D plugin:
@@ -29,6 +33,8 @@
 IAGSEngine* engine = nullptr;
 Screen screen;
 std::unique_ptr<RenderFactory> factory;
+// Set once the factory has initialized the engine's device
+bool gfxDeviceReady = false;
 
 extern void RegisterScriptAPI();
 
@@ -55,6 +61,7 @@ RenderFactory* CreateFactory(const char* driverid)
     {
         factory = std::make_unique<OGLFactory>();
     }
+    gfxDeviceReady = false;
     return factory.get();
 }
 
@@ -121,7 +128,10 @@ void AGS_EngineShutdown()
 #if defined (VIDEO_PLAYBACK)
     VideoObject::CleanUp();
 #endif
+    ImageLoader::CleanUp();
+    TexturePrefetch::CleanUp();
     factory.reset();
+    TextureContainer::UnmountAll();
 
     CLOSE_DBG();
 }
@@ -161,6 +171,7 @@ void Render( BaseObject::RenderStage stage )
         GetFactory()->SetScreenMatrixes(&screen, nullptr, nullptr, nullptr);
     }
 	
+    GetFactory()->BeginRenderStage();
     BaseObject::RenderAll( stage );
 
     for ( auto i = manualRenderBatch.begin(); i != manualRenderBatch.end(); ++i )
@@ -170,6 +181,8 @@ void Render( BaseObject::RenderStage stage )
             (*i)->Render();
         }
     }
+
+    GetFactory()->EndRenderStage();
 }
 
 int AGS_EngineOnEvent( int ev, int data )
@@ -184,6 +197,11 @@ int AGS_EngineOnEvent( int ev, int data )
     }
     else if ( ev == AGSE_PRERENDER )
     {
+        // Textures of the room entered are created before its objects
+        if ( gfxDeviceReady )
+        {
+            TexturePrefetch::EnterRoom();
+        }
         BaseObject::UpdateAll();
     }
     else if ( ev == AGSE_PRESCREENDRAW )
@@ -208,6 +226,11 @@ int AGS_EngineOnEvent( int ev, int data )
 
         // FIXME: won't work on 64-bit systems!!! use extended engine API?
         GetFactory()->InitGfxDevice(reinterpret_cast<void*>(data));
+        gfxDeviceReady = true;
+
+        // Create textures of the decoded files, and of the room before its objects are drawn
+        TextureCache::Update();
+        TexturePrefetch::Update();
 
         Render( BaseObject::STAGE_BACKGROUND );
     }
@@ -38,6 +38,8 @@ void D3D9Factory::SetScreenMatrixes(Screen* screen, float(*world)[16], float(*vi
         memcpy(screen->globalWorld.marr, *world, sizeof(float[16]));
         memcpy(screen->globalView.marr, *view, sizeof(float[16]));
         memcpy(screen->globalProj.marr, *proj, sizeof(float[16]));
+        MatrixMulD3D(&screen->stageMatrix, &screen->globalWorld, &screen->globalView);
+        MatrixMulD3D(&screen->stageMatrix, &screen->stageMatrix, &screen->globalProj);
         screen->matrixValid = true;
     }
     else
@@ -45,6 +47,7 @@ void D3D9Factory::SetScreenMatrixes(Screen* screen, float(*world)[16], float(*vi
         SetMatrixIdentity(&screen->globalWorld);
         SetMatrixIdentity(&screen->globalView);
         SetMatrixIdentity(&screen->globalProj);
+        SetMatrixIdentity(&screen->stageMatrix);
         screen->matrixValid = false;
     }
 }
@@ -54,4 +57,20 @@ std::unique_ptr<RenderObject> D3D9Factory::CreateRenderObject()
     return std::make_unique<D3D9RenderObject>();
 }
 
+bool D3D9Factory::IsYUVSupported()
+{
+    // Fixed function pipeline cannot convert the colors
+    return false;
+}
+
+void D3D9Factory::BeginRenderStage()
+{
+    // Direct3D states are not shadowed
+}
+
+void D3D9Factory::EndRenderStage()
+{
+    // Direct3D objects are drawn immediately
+}
+
 #endif // WINDOWS_VERSION
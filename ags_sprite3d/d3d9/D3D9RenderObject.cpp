@@ -8,10 +8,13 @@
 #include "D3DHelper.h"
 #include "D3D9Factory.h"
 #include "ImageHelper.h"
+#include "TextureContainer.h"
+#include "TextureResidency.h"
 
 
 D3D9RenderObject::~D3D9RenderObject()
 {
+    TextureResidency::Remove(this);
     if (myTexture)
     {
         myTexture->Release();
@@ -21,12 +24,46 @@ D3D9RenderObject::~D3D9RenderObject()
 
 void D3D9RenderObject::CreateTexture(int sprite_id, int bkg_num, const char *file)
 {
-    if (sprite_id >= 0)
+    mySpriteID = sprite_id;
+    myBackground = bkg_num;
+    myFile = file ? file : "";
+    mySourceRoom = bkg_num >= 0 ? GetAGS()->GetCurrentRoom() : -1;
+    LoadTexture();
+}
+
+size_t D3D9RenderObject::GetMemorySize()
+{
+    // Only what may be evicted counts
+    if (!CanEvict() || myIsEvicted || !myTexture)
+        return 0;
+    return static_cast<size_t>(myTexWidth) * myTexHeight * 4;
+}
+
+void D3D9RenderObject::Evict()
+{
+    if (!CanEvict())
+        return;
+    if (myTexture)
     {
-        BITMAP* bmp = GetAGS()->GetSpriteGraphic(sprite_id);
-        myWidth = GetAGS()->GetSpriteWidth(sprite_id);
-        myHeight = GetAGS()->GetSpriteHeight(sprite_id);
-        myHasAlpha = GetAGS()->IsSpriteAlphaBlended(sprite_id) != 0;
+        myTexture->Release();
+        myTexture = NULL;
+    }
+    myIsEvicted = true;
+}
+
+void D3D9RenderObject::LoadTexture()
+{
+    if (mySpriteID >= 0)
+    {
+        BITMAP* bmp = GetAGS()->GetSpriteGraphic(mySpriteID);
+        if (!bmp)
+        {
+            DBGF("Could not open sprite #%d", mySpriteID);
+            return;
+        }
+        myWidth = GetAGS()->GetSpriteWidth(mySpriteID);
+        myHeight = GetAGS()->GetSpriteHeight(mySpriteID);
+        myHasAlpha = GetAGS()->IsSpriteAlphaBlended(mySpriteID) != 0;
         myTexWidth = myWidth;
         myTexHeight = myHeight;
 
@@ -34,14 +71,21 @@ void D3D9RenderObject::CreateTexture(int sprite_id, int bkg_num, const char *fil
 
         myTexture = ::CreateTexture(data, myWidth, myHeight, myHasAlpha);
 
+        GetAGS()->ReleaseBitmapSurface(bmp);
+
         if (!myTexture)
         {
-            DBGF("Could not open sprite #%d", sprite_id);
+            DBGF("Could not open sprite #%d", mySpriteID);
         }
     }
-    else if (bkg_num >= 0)
+    else if (myBackground >= 0)
     {
-        BITMAP* bmp = GetAGS()->GetBackgroundScene(bkg_num);
+        BITMAP* bmp = GetAGS()->GetBackgroundScene(myBackground);
+        if (!bmp)
+        {
+            DBGF("Could not open room background #%d", myBackground);
+            return;
+        }
         int unused;
         GetAGS()->GetBitmapDimensions(bmp, &myWidth, &myHeight, &unused);
         myHasAlpha = false;
@@ -52,32 +96,56 @@ void D3D9RenderObject::CreateTexture(int sprite_id, int bkg_num, const char *fil
 
         myTexture = ::CreateTexture(data, myWidth, myHeight);
 
+        GetAGS()->ReleaseBitmapSurface(bmp);
+
         if (!myTexture)
         {
-            DBGF("Could not open room background #%d", bkg_num);
+            DBGF("Could not open room background #%d", myBackground);
         }
     }
-    else if (file)
+    else if (!myFile.empty())
     {
         ImageInfo info;
+        const unsigned char *pixels;
         std::vector<unsigned char> data;
-        if (LoadImage(file, data, info))
-        {
-            myWidth = info.Width;
-            myHeight = info.Height;
-            myTexWidth = myWidth;
-            myTexHeight = myHeight;
-            myHasAlpha = info.HasAlpha;
-            myTexture = ::CreateTexture(&data[0], info.Width, info.Height, info.HasAlpha);
-        }
+        // Packed images are uploaded straight from the mapped container
+        if (TextureContainer::Find(myFile.c_str(), pixels, info))
+            CreateImageTexture(pixels, info);
+        else if (LoadImage(myFile.c_str(), data, info))
+            CreateImageTexture(&data[0], info);
 
         if (!myTexture)
         {
-            DBGF("Could not create texture from file %s", file);
+            DBGF("Could not create texture from file %s", myFile.c_str());
         }
     }
 }
 
+void D3D9RenderObject::CreateTexture(const char *file, const std::vector<unsigned char> &data, const ImageInfo &info)
+{
+    if (myTexture)
+    {
+        myTexture->Release();
+        myTexture = NULL;
+    }
+    mySpriteID = -1;
+    myBackground = -1;
+    myFile = file;
+    mySourceRoom = -1;
+    myIsEvicted = false;
+    CreateImageTexture(&data[0], info);
+}
+
+void D3D9RenderObject::CreateImageTexture(const unsigned char *data, const ImageInfo &info)
+{
+    myWidth = info.Width;
+    myHeight = info.Height;
+    myTexWidth = myWidth;
+    myTexHeight = myHeight;
+    myHasAlpha = info.HasAlpha;
+    myTexture = ::CreateTexture(data, info.Width, info.Height, info.HasAlpha);
+}
+
 void D3D9RenderObject::CreateTexture(const unsigned char* data, int width, int height, int bpp)
 {
     if (!myTexture || myTexWidth != width || myTexHeight != height)
@@ -104,13 +172,65 @@ void D3D9RenderObject::CreateTexture(const unsigned char* data, int width, int h
     }
 }
 
-void D3D9RenderObject::Render(const Point &pos, const PointF &scaling, float rotation,
+void D3D9RenderObject::CreateYUVTexture(const unsigned char* data, int width, int height)
+{
+    // Not supported, see D3D9Factory::IsYUVSupported
+}
+
+bool D3D9RenderObject::Render(const Point &pos, const PointF &scaling, float rotation,
     const PointF &anchorPos, const RGBA &rgba, int filter)
 {
     //DBG("myRender::Render");
     IDirect3DDevice9* device = GetD3D();
     const Screen *screen = GetScreen();
 
+    float screenScaleX = 1.0;
+    float screenScaleY = 1.0;
+    if (screen->matrixValid)
+    {
+        float orthoSizeX = 2.f / screen->globalProj._11;
+        float orthoSizeY = 2.f / screen->globalProj._22;
+        screenScaleX = orthoSizeX / screen->width;
+        screenScaleY = orthoSizeY / screen->height;
+        //DBGF("---ORTHO w = %f, h = %f", orthoSizeX, orthoSizeY);
+    }
+    else
+    {
+    }
+
+    //DBGF("---RENDER screenScale: %f,%f", screenScaleX, screenScaleY);
+
+    // Object transform: anchor, scaling, rotation and position
+    Affine2D local;
+    SetAffine(&local, pos.x - screenScaleX * screen->width / 2.f,
+        pos.y - (1.f + 1.f - screenScaleY) * screen->height / 2.f,
+        screenScaleX * myWidth * scaling.x, screenScaleY * myHeight * scaling.y,
+        rotation * RADS_PER_DEGREE,
+        -anchorPos.x, anchorPos.y); // Mirror Y
+
+    // Apply global world matrix too
+    Matrix world;
+    MatrixMulAffine(&world, &local, &screen->globalWorld);
+
+    // Skip objects that are completely off screen;
+    // without engine matrixes we cannot tell where they end up
+    if (screen->culling && screen->matrixValid)
+    {
+        Matrix mvp;
+        MatrixMulAffine(&mvp, &local, &screen->stageMatrix);
+        if (IsRectOutsideClip(&mvp, -0.5f, -0.5f, 0.5f, 0.5f))
+            return false;
+    }
+
+    if (myIsEvicted)
+    {
+        // Background may only be read back in its own room
+        if (mySourceRoom >= 0 && mySourceRoom != GetAGS()->GetCurrentRoom())
+            return true;
+        LoadTexture();
+        myIsEvicted = false;
+    }
+
     device->SetTextureStageState(0, D3DTSS_COLORARG1, D3DTA_TEXTURE);
     device->SetTextureStageState(0, D3DTSS_COLORARG2, D3DTA_DIFFUSE);
     device->SetTextureStageState(0, D3DTSS_COLOROP, D3DTOP_MODULATE);
@@ -132,42 +252,6 @@ void D3D9RenderObject::Render(const Point &pos, const PointF &scaling, float rot
 
     device->SetTextureStageState(1, D3DTSS_TEXTURETRANSFORMFLAGS, D3DTTFF_COUNT2);
 
-    float screenScaleX = 1.0;
-    float screenScaleY = 1.0;
-    if (screen->matrixValid)
-    {
-        float orthoSizeX = 2.f / screen->globalProj._11;
-        float orthoSizeY = 2.f / screen->globalProj._22;
-        screenScaleX = orthoSizeX / screen->width;
-        screenScaleY = orthoSizeY / screen->height;
-        //DBGF("---ORTHO w = %f, h = %f", orthoSizeX, orthoSizeY);
-    }
-    else
-    {
-    }
-
-    //DBGF("---RENDER screenScale: %f,%f", screenScaleX, screenScaleY);
-
-    // World matrix, set position, anchor, rotation and scaling
-    Matrix trans, scale, rot, anchor;
-    //DBGF("---RENDER TRANS: %f,%f", pos.x - screenScaleX * screen->width / 2.f, pos.y - (1.f + 1.f - screenScaleY) * screen->height / 2.f);
-    SetMatrix(&trans, pos.x - screenScaleX * screen->width / 2.f,
-        pos.y - (1.f + 1.f - screenScaleY) * screen->height / 2.f,
-        1, 1);
-    //DBGF("---RENDER SCALE: %f,%f", screenScaleX * myWidth * scaling.x, screenScaleY * myHeight * scaling.y);
-    SetMatrix(&scale, 0, 0, screenScaleX * myWidth * scaling.x, screenScaleY * myHeight * scaling.y);
-    //DBGF("---RENDER ROTATION: %f at %f,%f", rotation, -anchorPos.x, anchorPos.y);
-    SetMatrix(&anchor, -anchorPos.x, anchorPos.y, 1, 1); // Mirror Y
-    SetMatrixRotation(&rot, rotation * RADS_PER_DEGREE);
-
-    Matrix world;
-    // Apply self-transform first
-    MatrixMulD3D(&world, &anchor, &scale);
-    MatrixMulD3D(&world, &world, &rot);
-    MatrixMulD3D(&world, &world, &trans);
-    // Apply global world matrix too
-    MatrixMulD3D(&world, &world, &screen->globalWorld);
-
     // Set transforms
     device->SetTransform(D3DTS_WORLD, reinterpret_cast<const D3DMATRIX*>(&world));
     device->SetTransform(D3DTS_VIEW, reinterpret_cast<const D3DMATRIX*>(&screen->globalView));
@@ -223,6 +307,7 @@ void D3D9RenderObject::Render(const Point &pos, const PointF &scaling, float rot
 
     // Restore old vertex format
     device->SetFVF(oldFVF);
+    return true;
 }
 
 #endif // WINDOWS_VERSION
@@ -3,6 +3,7 @@
 
 #if defined (WINDOWS_VERSION)
 
+#include <string>
 #include <d3d9.h>
 #include "MathHelper.h"
 #include "RenderObject.h"
@@ -14,21 +15,41 @@ public:
     ~D3D9RenderObject() override;
 
     void CreateTexture(int sprite_id, int bkg_num, const char *file) override;
+    void CreateTexture(const char *file, const std::vector<unsigned char> &data, const ImageInfo &info) override;
     void CreateTexture(const unsigned char* data, int width, int height, int bpp) override;
-    void Render(const Point &pos, const PointF &scaling, float rotation, const PointF &anchorPos,
+    void CreateYUVTexture(const unsigned char* data, int width, int height) override;
+    bool Render(const Point &pos, const PointF &scaling, float rotation, const PointF &anchorPos,
         const RGBA &rgba, int filtering) override;
 
     int GetTexWidth() override { return myTexWidth; }
     int GetTexHeight() override { return myTexHeight; }
     bool GetHasAlpha() override { return myHasAlpha; }
 
+    size_t GetMemorySize() override;
+    void Evict() override;
+    int GetSourceRoom() override { return mySourceRoom; }
+
 private:
+    // Creates texture from the source given to CreateTexture
+    void LoadTexture();
+    void CreateImageTexture(const unsigned char *data, const ImageInfo &info);
+    // Engine sprites are not evicted: dynamic ones may be deleted or drawn on
+    // meanwhile, and reading them again would show some other image
+    bool CanEvict() const { return myBackground >= 0 || !myFile.empty(); }
+
     IDirect3DTexture9* myTexture = nullptr;
     int myWidth = 0;
     int myHeight = 0;
     int myTexWidth = 0;
     int myTexHeight = 0;
     bool myHasAlpha = false;
+
+    // Source of the texture, to create it again after eviction
+    int mySpriteID = -1;
+    int myBackground = -1;
+    std::string myFile;
+    int mySourceRoom = -1;
+    bool myIsEvicted = false;
 };
 
 #endif // WINDOWS_VERSION
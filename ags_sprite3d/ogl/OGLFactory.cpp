@@ -2,9 +2,51 @@
 #include <glad/glad.h>
 #include "Common.h"
 #include "OGLRenderObject.h"
+#include "OGLSpriteBatch.h"
+#include "OGLState.h"
+#include "OGLStreamingTexture.h"
+#include "OGLTextureAtlas.h"
 
 
 bool glInitialized = false;
+OGLSpriteBatch spriteBatch;
+OGLTextureAtlas textureAtlas;
+OGLState glState;
+OGLStreamingTexturePool streamingTexturePool;
+
+OGLSpriteBatch* GetSpriteBatch()
+{
+    return &spriteBatch;
+}
+
+OGLState* GetGLState()
+{
+    return &glState;
+}
+
+OGLTextureAtlas* GetTextureAtlas()
+{
+    return &textureAtlas;
+}
+
+OGLStreamingTexturePool* GetStreamingTexturePool()
+{
+    return &streamingTexturePool;
+}
+
+OGLFactory::~OGLFactory()
+{
+    // Factory goes away while the engine's context is still current;
+    // next factory creates everything anew
+    if (glInitialized)
+    {
+        streamingTexturePool.Clear();
+        textureAtlas.Destroy();
+        spriteBatch.Destroy();
+        OGLRenderObject::DestroyStaticData();
+        glInitialized = false;
+    }
+}
 
 void OGLFactory::InitGfxDevice(void* data)
 {
@@ -26,7 +68,10 @@ void OGLFactory::InitGfxDevice(void* data)
         return;
     }
 
-    if (!OGLRenderObject::CreateStaticData())
+    // Nothing known of the bindings or textures of a new context
+    glState = OGLState();
+
+    if (!OGLRenderObject::CreateStaticData() || !spriteBatch.Create())
     {
         GetAGS()->AbortGame("Plugin failed to initialize starting OpenGL resources.");
         return;
@@ -50,6 +95,8 @@ void OGLFactory::SetScreenMatrixes(Screen* screen, float(*world)[16], float(*vie
         memcpy(screen->globalWorld.marr, *world, sizeof(float[16]));
         memcpy(screen->globalView.marr, *view, sizeof(float[16]));
         memcpy(screen->globalProj.marr, *proj, sizeof(float[16]));
+        MatrixMulD3D(&screen->stageMatrix, &screen->globalWorld, &screen->globalView);
+        MatrixMulD3D(&screen->stageMatrix, &screen->stageMatrix, &screen->globalProj);
         screen->matrixValid = true;
     }
     else
@@ -57,6 +104,7 @@ void OGLFactory::SetScreenMatrixes(Screen* screen, float(*world)[16], float(*vie
         SetMatrixIdentity(&screen->globalWorld);
         SetMatrixIdentity(&screen->globalView);
         SetMatrixIdentity(&screen->globalProj);
+        SetMatrixIdentity(&screen->stageMatrix);
         screen->matrixValid = false;
     }
 }
@@ -65,3 +113,20 @@ std::unique_ptr<RenderObject> OGLFactory::CreateRenderObject()
 {
     return std::make_unique<OGLRenderObject>();
 }
+
+bool OGLFactory::IsYUVSupported()
+{
+    return OGLRenderObject::IsYUVSupported();
+}
+
+void OGLFactory::BeginRenderStage()
+{
+    // Textures uploaded since the last stage left bindings the engine may have changed
+    glState.Forget();
+}
+
+void OGLFactory::EndRenderStage()
+{
+    if (glInitialized)
+        spriteBatch.EndStage();
+}
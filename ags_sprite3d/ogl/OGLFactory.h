@@ -3,13 +3,28 @@
 
 #include "RenderFactory.h"
 
+class OGLSpriteBatch;
+class OGLState;
+class OGLStreamingTexturePool;
+class OGLTextureAtlas;
+
 class OGLFactory : public RenderFactory
 {
 public:
+    ~OGLFactory() override;
+
     void InitGfxDevice(void* data) override;
     bool InitGfxMode(Screen* screen, void* data) override;
     void SetScreenMatrixes(Screen* screen, float(*world)[16], float(*view)[16], float(*proj)[16]) override;
     std::unique_ptr<RenderObject> CreateRenderObject() override;
+    bool IsYUVSupported() override;
+    void BeginRenderStage() override;
+    void EndRenderStage() override;
 };
 
+OGLSpriteBatch* GetSpriteBatch();
+OGLState* GetGLState();
+OGLTextureAtlas* GetTextureAtlas();
+OGLStreamingTexturePool* GetStreamingTexturePool();
+
 #endif // SPRITE3D_OGLFACTORY_H
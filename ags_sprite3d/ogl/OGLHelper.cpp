@@ -3,56 +3,121 @@
 #include <vector>
 #include <glad/glad.h>
 #include "Common.h"
+#include "OGLFactory.h"
+#include "OGLState.h"
 
 
-unsigned CreateTexture(unsigned char const* data, int width, int height, bool alpha)
+bool GetPixelFormat(int bpp, GLenum &format, GLenum &type)
+{
+    switch (bpp)
+    {
+    case 4: format = GL_BGRA; type = GL_UNSIGNED_BYTE; return true;
+    case 3: format = GL_BGR; type = GL_UNSIGNED_BYTE; return true;
+    case 2: format = GL_RGB; type = GL_UNSIGNED_SHORT_5_6_5; return true;
+    default: return false;
+    }
+}
+
+// Uploads pixels whose rows are rowLength pixels apart
+static bool UploadTexture(unsigned texture, unsigned char const* pixels, int width, int height, int bpp, int rowLength)
+{
+    GLenum format, type;
+    if (!GetPixelFormat(bpp, format, type))
+    {
+        DBGF("OGL: unsupported texture format, %d bytes per pixel", bpp);
+        return false;
+    }
+
+    GetGLState()->BindTexture(texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, (rowLength * bpp) % 4 == 0 ? 4 : 1);
+#if !AGS_OPENGL_ES2
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, rowLength != width ? rowLength : 0);
+#endif
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, format, type, pixels);
+    // Put back the defaults
+#if !AGS_OPENGL_ES2
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+#endif
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    GetGLState()->BindTexture(0);
+    return true;
+}
+
+// Uploads copy the data before returning, so one buffer serves them all;
+// larger requests, like whole backgrounds, get their own buffer until released
+static const size_t MaxStagingSize = 1024 * 1024;
+static std::vector<unsigned char> staging;
+static std::vector<unsigned char> largeStaging;
+
+unsigned char* GetStagingBuffer(size_t size)
+{
+    std::vector<unsigned char> &buffer = size > MaxStagingSize ? largeStaging : staging;
+    if (buffer.size() < size)
+        buffer.resize(size);
+    return &buffer[0];
+}
+
+void ReleaseStagingBuffer()
+{
+    std::vector<unsigned char>().swap(largeStaging);
+}
+
+unsigned CreateTexture(unsigned char const* data, int width, int height, int bpp, bool alpha)
 {
     unsigned texture;
     glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
-    SetTextureData(texture, data, width, height);
+    GetGLState()->SetTextureParams(texture, GL_NEAREST, GL_CLAMP);
+    if (!SetTextureData(texture, data, width, height, bpp))
+    {
+        GetGLState()->DeleteTexture(texture);
+        return 0;
+    }
     return texture;
 }
 
-bool SetTextureData(unsigned texture, unsigned char const* data, int width, int height)
+bool SetTextureData(unsigned texture, unsigned char const* data, int width, int height, int bpp)
 {
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_BGRA, GL_UNSIGNED_BYTE, data);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    return true;
+    return UploadTexture(texture, data, width, height, bpp, width);
 }
 
-unsigned CreateTexture(unsigned char const* const* data, int width, int height, bool alpha)
+unsigned CreateTexture(unsigned char const* const* data, int width, int height, int bpp, bool alpha)
 {
     unsigned texture;
     glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
-    SetTextureData(texture, data, width, height);
+    GetGLState()->SetTextureParams(texture, GL_NEAREST, GL_CLAMP);
+    if (!SetTextureData(texture, data, width, height, bpp))
+    {
+        GetGLState()->DeleteTexture(texture);
+        return 0;
+    }
     return texture;
 }
 
-bool SetTextureData(unsigned texture, unsigned char const* const* data, int width, int height)
+bool SetTextureData(unsigned texture, unsigned char const* const* data, int width, int height, int bpp)
 {
-    int bpp = 4; // TODO: get from elsewhere?
-    std::vector<unsigned char> input( width * height * bpp );
-    int pitch = width * bpp;
+    if (width <= 0 || height <= 0)
+        return false;
+
+    const ptrdiff_t pitch = width * bpp;
+#if !AGS_OPENGL_ES2
+    // Engine bitmaps normally keep their rows in one block at equal distance,
+    // in which case they are read in place; ES2 has no unpack row length
+    const ptrdiff_t stride = height > 1 ? data[1] - data[0] : pitch;
+    bool inPlace = stride >= pitch && stride % bpp == 0;
+    for (int y = 2; inPlace && y < height; ++y)
+        inPlace = data[y] - data[y - 1] == stride;
+    if (inPlace)
+        return UploadTexture(texture, data[0], width, height, bpp, static_cast<int>(stride / bpp));
+#endif
+
+    unsigned char *input = GetStagingBuffer(pitch * height);
     for (int y = 0; y < height; ++y)
     {
-        memcpy(&input[0] + pitch * y, data[y], pitch);
+        memcpy(input + pitch * y, data[y], pitch);
     }
-    
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_BGRA, GL_UNSIGNED_BYTE, &input[0]);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    return true;
+    bool result = UploadTexture(texture, input, width, height, bpp, width);
+    ReleaseStagingBuffer();
+    return result;
 }
 
 void OutputShaderError(GLuint obj_id, const char* obj_name, bool is_shader)
@@ -114,6 +179,8 @@ bool CreateShaderProgram(ShaderProgram &prg, const char *name, const char *verte
     GLuint program = glCreateProgram();
     glAttachShader(program, vertex_shader);
     glAttachShader(program, fragment_shader);
+    // Compatibility profile only draws if attribute 0 is a per-vertex array
+    glBindAttribLocation(program, 0, "a_Position");
     glLinkProgram(program);
     glGetProgramiv(program, GL_LINK_STATUS, &result);
     if (result == GL_FALSE)
@@ -132,6 +199,21 @@ bool CreateShaderProgram(ShaderProgram &prg, const char *name, const char *verte
     glDeleteShader(fragment_shader);
 
     prg.Program = program;
+    prg.TextureId = glGetUniformLocation(program, "textID");
+    prg.PositionAttr = glGetAttribLocation(program, "a_Position");
+    prg.TexCoordAttr = glGetAttribLocation(program, "a_TexCoord");
+    prg.ColorAttr = glGetAttribLocation(program, "a_Color");
+    prg.TransformAttr[0] = glGetAttribLocation(program, "a_TransformX");
+    prg.TransformAttr[1] = glGetAttribLocation(program, "a_TransformY");
+    prg.TransformAttr[2] = glGetAttribLocation(program, "a_TransformW");
+    prg.TexRectAttr = glGetAttribLocation(program, "a_TexRect");
+    // Sampler always reads the first texture unit
+    if (prg.TextureId >= 0)
+    {
+        GetGLState()->UseProgram(program);
+        glUniform1i(prg.TextureId, 0);
+        GetGLState()->UseProgram(0);
+    }
     DBGF("OGL: %s shader program created successfully", name);
     return true;
 }
@@ -1,34 +1,61 @@
 #ifndef SPRITE3D_OGLHELPER_H
 #define SPRITE3D_OGLHELPER_H
 
+#include <cstddef>
 #include <glad/glad.h>
 
-struct OGLVECTOR2D
+struct OGLBATCHVERTEX
 {
-    float x = 0.f;
-    float y = 0.f;
+    float x, y, z, w; // position in clip space
+    float tu, tv;
+    float r, g, b, a;
 };
 
-struct OGLCUSTOMVERTEX
+// Texture coordinates of a sprite's image
+struct OGLTEXRECT
 {
-    OGLVECTOR2D position;
-    float tu = 0.f;
-    float tv = 0.f;
+    float u0 = 0.f, v0 = 0.f;
+    float u1 = 1.f, v1 = 1.f;
+};
+
+// Per-sprite data for the instanced drawing; corner (x, y) of the unit quad
+// ends up at x * transformX + y * transformY + transformW in clip space
+struct OGLSPRITEINSTANCE
+{
+    float transformX[4];
+    float transformY[4];
+    float transformW[4];
+    OGLTEXRECT uv;
+    float r, g, b, a;
 };
 
 struct ShaderProgram
 {
     GLuint Program = 0;
 
-    GLuint MVPMatrix = 0;
-    GLuint TextureId = 0;
-    GLuint Color = 0;
+    // Locations cached on creation, -1 if shader does not have one
+    GLint TextureId = -1;
+    GLint PositionAttr = -1;
+    GLint TexCoordAttr = -1;
+    GLint ColorAttr = -1;
+    // Per-instance attributes, only present in the instanced shaders
+    GLint TransformAttr[3] = { -1, -1, -1 };
+    GLint TexRectAttr = -1;
+
+    bool IsInstanced() const { return TransformAttr[0] >= 0; }
 };
 
-unsigned CreateTexture(unsigned char const* data, int width, int height, bool alpha = false);
-bool SetTextureData(unsigned texture, unsigned char const* data, int width, int height);
-unsigned CreateTexture(unsigned char const* const* data, int width, int height, bool alpha = false);
-bool SetTextureData(unsigned texture, unsigned char const* const* data, int width, int height);
+// Source pixel layout for the given bytes per pixel
+bool GetPixelFormat(int bpp, GLenum &format, GLenum &type);
+unsigned CreateTexture(unsigned char const* data, int width, int height, int bpp, bool alpha = false);
+bool SetTextureData(unsigned texture, unsigned char const* data, int width, int height, int bpp);
+unsigned CreateTexture(unsigned char const* const* data, int width, int height, int bpp, bool alpha = false);
+bool SetTextureData(unsigned texture, unsigned char const* const* data, int width, int height, int bpp);
+// Scratch memory for converting pixels before upload, valid until the next call
+// or until released; only for the thread which owns the GL context
+unsigned char* GetStagingBuffer(size_t size);
+// Frees the memory given for a large upload; small buffer is kept for reuse
+void ReleaseStagingBuffer();
 bool CreateShaderProgram(ShaderProgram &prg, const char *name, const char *vertex_shader_src, const char *fragment_shader_src);
 void DeleteShaderProgram(ShaderProgram &prg);
 
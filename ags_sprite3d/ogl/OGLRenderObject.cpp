@@ -4,10 +4,18 @@
 #include "Common.h"
 #include "BaseObject.h"
 #include "ImageHelper.h"
+#include "OGLFactory.h"
+#include "OGLSpriteBatch.h"
+#include "OGLState.h"
+#include "OGLTextureAtlas.h"
+#include "TextureContainer.h"
+#include "TextureResidency.h"
 
 
-OGLCUSTOMVERTEX OGLRenderObject::defaultVertices[4]{};
 ShaderProgram OGLRenderObject::defaultProgram;
+ShaderProgram OGLRenderObject::instancedProgram;
+ShaderProgram OGLRenderObject::yuvProgram;
+ShaderProgram OGLRenderObject::yuvInstancedProgram;
 
 static const auto default_vertex_shader_src = ""
 #if AGS_OPENGL_ES2
@@ -16,16 +24,44 @@ static const auto default_vertex_shader_src = ""
 "#version 120 \n"
 #endif
 R"EOS(
-uniform mat4 uMVPMatrix;
-
-attribute vec2 a_Position;
+attribute vec4 a_Position;
 attribute vec2 a_TexCoord;
+attribute vec4 a_Color;
 
 varying vec2 v_TexCoord;
+varying vec4 v_Color;
 
 void main() {
   v_TexCoord = a_TexCoord;
-  gl_Position = uMVPMatrix * vec4(a_Position.xy, 0.0, 1.0);
+  v_Color = a_Color;
+  gl_Position = a_Position;
+}
+
+)EOS";
+
+
+// Draws every sprite as an instance of the unit quad, see OGLSPRITEINSTANCE
+static const auto instanced_vertex_shader_src = ""
+#if AGS_OPENGL_ES2
+"#version 100 \n"
+#else
+"#version 120 \n"
+#endif
+R"EOS(
+attribute vec2 a_Position;
+attribute vec4 a_TransformX;
+attribute vec4 a_TransformY;
+attribute vec4 a_TransformW;
+attribute vec4 a_TexRect;
+attribute vec4 a_Color;
+
+varying vec2 v_TexCoord;
+varying vec4 v_Color;
+
+void main() {
+  v_TexCoord = mix(a_TexRect.xy, a_TexRect.zw, vec2(a_Position.x, -a_Position.y));
+  v_Color = a_Color;
+  gl_Position = a_Position.x * a_TransformX + a_Position.y * a_TransformY + a_TransformW;
 }
 
 )EOS";
@@ -40,144 +76,275 @@ static const auto default_fragment_shader_src = ""
 #endif
 R"EOS(
 uniform sampler2D textID;
-uniform vec4 rgba;
 
 varying vec2 v_TexCoord;
+varying vec4 v_Color;
+
+void main() {
+  gl_FragColor = texture2D(textID, v_TexCoord) * v_Color;
+}
+)EOS";
+
+
+// Video frames uploaded as BGR, so Y ends up in blue and V in red;
+// Theora uses BT.601 colors with the limited range
+static const auto yuv_fragment_shader_src = ""
+#if AGS_OPENGL_ES2
+"#version 100 \n"
+"precision mediump float; \n"
+#else
+"#version 120 \n"
+#endif
+R"EOS(
+uniform sampler2D textID;
+
+varying vec2 v_TexCoord;
+varying vec4 v_Color;
+
+const mat3 yuv_to_rgb = mat3(
+  1.164,  1.164, 1.164,
+  0.0,   -0.392, 2.017,
+  1.596, -0.813, 0.0);
 
 void main() {
-  vec4 src_col = texture2D(textID, v_TexCoord);
-  gl_FragColor = vec4(src_col.x * rgba.x, src_col.y * rgba.y,
-                      src_col.z * rgba.z, src_col.w * rgba.w);
+  vec3 yuv = texture2D(textID, v_TexCoord).bgr - vec3(16.0 / 255.0, 0.5, 0.5);
+  gl_FragColor = vec4(yuv_to_rgb * yuv, 1.0) * v_Color;
 }
 )EOS";
 
 
 bool CreateDefaultShader(ShaderProgram &prg)
 {
-    if (!CreateShaderProgram(prg, "Default", default_vertex_shader_src, default_fragment_shader_src)) return false;
-    prg.MVPMatrix = glGetUniformLocation(prg.Program, "uMVPMatrix");
-    prg.TextureId = glGetUniformLocation(prg.Program, "textID");
-    prg.Color = glGetUniformLocation(prg.Program, "rgba");
-    return true;
+    return CreateShaderProgram(prg, "Default", default_vertex_shader_src, default_fragment_shader_src);
 }
 
-bool OGLRenderObject::CreateStaticData()
+bool CreateInstancedShader(ShaderProgram &prg)
+{
+    return CreateShaderProgram(prg, "Instanced", instanced_vertex_shader_src, default_fragment_shader_src);
+}
+
+bool CreateYUVShader(ShaderProgram &prg)
 {
-    // Default vertices
-    defaultVertices[0].position.x = 0.0f;
-    defaultVertices[0].position.y = 0.0f;
-    defaultVertices[0].tu = 0.0;
-    defaultVertices[0].tv = 0.0;
-
-    defaultVertices[1].position.x = 1.0f;
-    defaultVertices[1].position.y = 0.0f;
-    defaultVertices[1].tu = 1.0;
-    defaultVertices[1].tv = 0.0;
-
-    defaultVertices[2].position.x = 0.0f;
-    defaultVertices[2].position.y = -1.0f;
-    defaultVertices[2].tu = 0.0;
-    defaultVertices[2].tv = 1.0;
-
-    defaultVertices[3].position.x = 1.0f;
-    defaultVertices[3].position.y = -1.0f;
-    defaultVertices[3].tu = 1.0;
-    defaultVertices[3].tv = 1.0;
+    return CreateShaderProgram(prg, "YUV", default_vertex_shader_src, yuv_fragment_shader_src);
+}
 
+bool CreateYUVInstancedShader(ShaderProgram &prg)
+{
+    return CreateShaderProgram(prg, "YUV instanced", instanced_vertex_shader_src, yuv_fragment_shader_src);
+}
+
+bool OGLRenderObject::CreateStaticData()
+{
     // Shaders
     bool shaders = CreateDefaultShader(defaultProgram);
+    // Optional, sprites are drawn as quads if this fails
+    if (shaders && OGLSpriteBatch::IsInstancingSupported())
+        CreateInstancedShader(instancedProgram);
+    // Optional, videos are decoded to RGB if this fails
+    if (shaders && CreateYUVShader(yuvProgram) && OGLSpriteBatch::IsInstancingSupported())
+        CreateYUVInstancedShader(yuvInstancedProgram);
 
     return shaders;
 }
 
+void OGLRenderObject::DestroyStaticData()
+{
+    DeleteShaderProgram(defaultProgram);
+    DeleteShaderProgram(instancedProgram);
+    DeleteShaderProgram(yuvProgram);
+    DeleteShaderProgram(yuvInstancedProgram);
+}
+
 OGLRenderObject::~OGLRenderObject()
+{
+    TextureResidency::Remove(this);
+    ReleaseTexture();
+    if (myStream)
+    {
+        GetSpriteBatch()->ReleaseTexture(myStream->GetTexture());
+        GetStreamingTexturePool()->Release(std::move(myStream));
+    }
+}
+
+void OGLRenderObject::ReleaseTexture()
 {
     if (myTexture)
     {
-        glDeleteTextures(1, &myTexture);
+        GetSpriteBatch()->ReleaseTexture(myTexture);
+        GetGLState()->DeleteTexture(myTexture);
         myTexture = 0u;
     }
+    if (myRegion)
+    {
+        GetTextureAtlas()->Release(myRegion);
+        myRegion = nullptr;
+    }
 }
 
 void OGLRenderObject::CreateTexture(int sprite_id, int bkg_num, const char *file)
 {
-    if (sprite_id >= 0)
+    mySpriteID = sprite_id;
+    myBackground = bkg_num;
+    myFile = file ? file : "";
+    mySourceRoom = bkg_num >= 0 ? GetAGS()->GetCurrentRoom() : -1;
+    LoadTexture();
+}
+
+size_t OGLRenderObject::GetMemorySize()
+{
+    // Only what may be evicted counts; atlas regions are left out, as
+    // freeing one does not free its page
+    if (!CanEvict() || myIsEvicted || !myTexture)
+        return 0;
+    return static_cast<size_t>(myTexWidth) * myTexHeight * 4;
+}
+
+void OGLRenderObject::Evict()
+{
+    if (!CanEvict() || myRegion)
+        return;
+    ReleaseTexture();
+    myIsEvicted = true;
+}
+
+void OGLRenderObject::LoadTexture()
+{
+    if (mySpriteID >= 0)
     {
-        BITMAP* bmp = GetAGS()->GetSpriteGraphic(sprite_id);
-        myWidth = GetAGS()->GetSpriteWidth(sprite_id);
-        myHeight = GetAGS()->GetSpriteHeight(sprite_id);
-        myHasAlpha = GetAGS()->IsSpriteAlphaBlended(sprite_id) != 0;
+        BITMAP* bmp = GetAGS()->GetSpriteGraphic(mySpriteID);
+        if (!bmp)
+        {
+            DBGF("Could not open sprite #%d", mySpriteID);
+            return;
+        }
+        int coldepth;
+        GetAGS()->GetBitmapDimensions(bmp, &myWidth, &myHeight, &coldepth);
+        myHasAlpha = GetAGS()->IsSpriteAlphaBlended(mySpriteID) != 0;
         myTexWidth = myWidth;
         myTexHeight = myHeight;
+        int bpp = (coldepth + 7) / 8;
 
         unsigned char** data = GetAGS()->GetRawBitmapSurface(bmp);
 
-        myTexture = ::CreateTexture(data, myWidth, myHeight, myHasAlpha);
+        // Small sprites share atlas pages, to be drawn in fewer batches
+        if (bpp == 4)
+            myRegion = GetTextureAtlas()->Add(data, myWidth, myHeight);
+        if (!myRegion)
+            myTexture = ::CreateTexture(data, myWidth, myHeight, bpp, myHasAlpha);
 
-        if (!myTexture)
+        GetAGS()->ReleaseBitmapSurface(bmp);
+
+        if (!myTexture && !myRegion)
         {
-            DBGF("Could not open sprite #%d", sprite_id);
+            DBGF("Could not open sprite #%d", mySpriteID);
         }
     }
-    else if (bkg_num >= 0)
+    else if (myBackground >= 0)
     {
-        BITMAP* bmp = GetAGS()->GetBackgroundScene(bkg_num);
-        int unused;
-        GetAGS()->GetBitmapDimensions(bmp, &myWidth, &myHeight, &unused);
+        BITMAP* bmp = GetAGS()->GetBackgroundScene(myBackground);
+        if (!bmp)
+        {
+            DBGF("Could not open room background #%d", myBackground);
+            return;
+        }
+        int coldepth;
+        GetAGS()->GetBitmapDimensions(bmp, &myWidth, &myHeight, &coldepth);
         myHasAlpha = false;
         myTexWidth = myWidth;
         myTexHeight = myHeight;
 
         unsigned char** data = GetAGS()->GetRawBitmapSurface(bmp);
 
-        myTexture = ::CreateTexture(data, myWidth, myHeight);
+        myTexture = ::CreateTexture(data, myWidth, myHeight, (coldepth + 7) / 8);
+
+        GetAGS()->ReleaseBitmapSurface(bmp);
 
         if (!myTexture)
         {
-            DBGF("Could not open room background #%d", bkg_num);
+            DBGF("Could not open room background #%d", myBackground);
         }
     }
-    else if (file)
+    else if (!myFile.empty())
     {
         ImageInfo info;
+        const unsigned char *pixels;
         std::vector<unsigned char> data;
-        if (LoadImage(file, data, info))
-        {
-            myWidth = info.Width;
-            myHeight = info.Height;
-            myTexWidth = myWidth;
-            myTexHeight = myHeight;
-            myHasAlpha = info.HasAlpha;
-            myTexture = ::CreateTexture(&data[0], info.Width, info.Height, info.HasAlpha);
-        }
+        // Packed images are uploaded straight from the mapped container
+        if (TextureContainer::Find(myFile.c_str(), pixels, info))
+            CreateImageTexture(pixels, info);
+        else if (LoadImage(myFile.c_str(), data, info))
+            CreateImageTexture(&data[0], info);
 
-        if (!myTexture)
+        if (!myTexture && !myRegion)
         {
-            DBGF("Could not create texture from file %s", file);
+            DBGF("Could not create texture from file %s", myFile.c_str());
         }
     }
 }
 
+void OGLRenderObject::CreateTexture(const char *file, const std::vector<unsigned char> &data, const ImageInfo &info)
+{
+    ReleaseTexture();
+    mySpriteID = -1;
+    myBackground = -1;
+    myFile = file;
+    mySourceRoom = -1;
+    myIsEvicted = false;
+    CreateImageTexture(&data[0], info);
+}
+
+void OGLRenderObject::CreateImageTexture(const unsigned char *data, const ImageInfo &info)
+{
+    myWidth = info.Width;
+    myHeight = info.Height;
+    myTexWidth = myWidth;
+    myTexHeight = myHeight;
+    myHasAlpha = info.HasAlpha;
+    if (info.BPP == 4 && myWidth <= OGLTextureAtlas::MaxImageSize && myHeight <= OGLTextureAtlas::MaxImageSize)
+    {
+        std::vector<const unsigned char*> rows(myHeight);
+        for (int y = 0; y < myHeight; ++y)
+            rows[y] = &data[y * myWidth * 4];
+        myRegion = GetTextureAtlas()->Add(&rows[0], myWidth, myHeight);
+    }
+    if (!myRegion)
+        myTexture = ::CreateTexture(data, info.Width, info.Height, info.BPP, info.HasAlpha);
+}
+
 void OGLRenderObject::CreateTexture(const unsigned char* data, int width, int height, int bpp)
 {
-    if (myTexture == 0 || myTexWidth != width || myTexHeight != height)
+    // Frames already queued for drawing must not see the new contents
+    if (myStream)
+        GetSpriteBatch()->ReleaseTexture(myStream->GetTexture());
+
+    if (!myStream || myStream->GetWidth() != width || myStream->GetHeight() != height ||
+        myStream->GetBPP() != bpp)
     {
-        if (myTexture > 0)
-            glDeleteTextures(1, &myTexture);
-        myTexture = ::CreateTexture(data, width, height);
+        GetStreamingTexturePool()->Release(std::move(myStream));
+        myStream = GetStreamingTexturePool()->Acquire(width, height, bpp);
+        if (!myStream)
+        {
+            DBGF("Could not create streaming texture %d x %d", width, height);
+            return;
+        }
         myWidth = width;
         myHeight = height;
         myTexWidth = width;
         myTexHeight = height;
         myHasAlpha = false; // CHECKME??
     }
-    else
-    {
-        ::SetTextureData(myTexture, data, width, height);
-    }
+    myStream->Update(data);
+    myIsYUV = false;
+}
+
+void OGLRenderObject::CreateYUVTexture(const unsigned char* data, int width, int height)
+{
+    // Uploaded as is, the shader does the conversion
+    CreateTexture(data, width, height, 3);
+    myIsYUV = true;
 }
 
-void OGLRenderObject::Render(const Point &pos, const PointF &scaling, float rotation,
+bool OGLRenderObject::Render(const Point &pos, const PointF &scaling, float rotation,
     const PointF &anchorPos, const RGBA &rgba, int filter)
 {
     //DBG("myRender::Render");
@@ -199,32 +366,29 @@ void OGLRenderObject::Render(const Point &pos, const PointF &scaling, float rota
 
     //DBGF("---RENDER screenScale: %f,%f", screenScaleX, screenScaleY);
 
-    // World matrix, set position, anchor, rotation and scaling
-    Matrix trans, scale, rot, anchor;
-    //DBGF("---RENDER TRANS: %f,%f", pos.x - screenScaleX * screen->width / 2.f, pos.y - (1.f + 1.f - screenScaleY) * screen->height / 2.f);
-    SetMatrix(&trans, pos.x - screenScaleX * screen->width / 2.f,
+    // Object transform: anchor, scaling, rotation and position
+    Affine2D local;
+    SetAffine(&local, pos.x - screenScaleX * screen->width / 2.f,
         pos.y - (1.f + 1.f - screenScaleY) * screen->height / 2.f,
-        //((1.f + 1.f - screenScaleY) * screen->height / 2.f) - pos.y,
-        1, 1);
-    //DBGF("---RENDER SCALE: %f,%f", screenScaleX * myWidth * scaling.x, screenScaleY * myHeight * scaling.y);
-    SetMatrix(&scale, 0, 0, screenScaleX * myWidth * scaling.x, screenScaleY * myHeight * scaling.y);
-    //DBGF("---RENDER ROTATION: %f at %f,%f", rotation, -anchorPos.x, anchorPos.y);
-    SetMatrix(&anchor, -anchorPos.x - 0.5f, anchorPos.y + 0.5f, 1.f, 1.f); // Mirror Y
-    SetMatrixRotation(&rot, rotation * RADS_PER_DEGREE);
+        screenScaleX * myWidth * scaling.x, screenScaleY * myHeight * scaling.y,
+        rotation * RADS_PER_DEGREE,
+        -anchorPos.x - 0.5f, anchorPos.y + 0.5f); // Mirror Y
 
+    // Followed by the render stage transform
     Matrix world;
-    // OpenGL multiplies matrixes in reverse:
-    // first global and then self transform
-    MatrixMulOGL(&world, &screen->globalProj, &screen->globalView);
-    MatrixMulOGL(&world, &world, &screen->globalWorld);
-    MatrixMulOGL(&world, &world, &trans);
+    MatrixMulAffine(&world, &local, &screen->stageMatrix);
     // FIXME: Origin is at the middle of the surface
     // perhaps pass from the engine as globalView?
     world._41 += 1.f;
     world._42 += 1.f;
-    MatrixMulOGL(&world, &world, &rot);
-    MatrixMulOGL(&world, &world, &scale);
-    MatrixMulOGL(&world, &world, &anchor);
+
+    // Skip objects that are completely off screen;
+    // without engine matrixes we cannot tell where they end up
+    if (screen->culling && screen->matrixValid &&
+        IsRectOutsideClip(&world, 0.f, 0.f, 1.f, -1.f))
+    {
+        return false;
+    }
 
 
     // Scale texture coordinates
@@ -233,41 +397,30 @@ void OGLRenderObject::Render(const Point &pos, const PointF &scaling, float rota
     float scaleV = myTexHeight / static_cast<float>(myHeight);
     */
 
-    // Default shader
-    const ShaderProgram &program = defaultProgram;
-    glUseProgram(program.Program);
-    glUniform1i(program.TextureId, 0);
-    glUniform4f(program.Color, rgba.r, rgba.g, rgba.b, rgba.a);
-    glUniformMatrix4fv(program.MVPMatrix, 1, GL_FALSE, world.marr);
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, myTexture);
-
-    if (filter == BaseObject::FILTER_LINEAR)
+    // Atlas page was lost along with the device, read the image again
+    if (myRegion && !myRegion->Texture)
     {
-        // Linear texture filtering
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        ReleaseTexture();
+        myIsEvicted = true;
     }
-    else if (filter == BaseObject::FILTER_NEAREST)
+    if (myIsEvicted)
     {
-        // Nearest neighbor filtering
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        // Background may only be read back in its own room
+        if (mySourceRoom >= 0 && mySourceRoom != GetAGS()->GetCurrentRoom())
+            return true;
+        LoadTexture();
+        myIsEvicted = false;
     }
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
-
-    glEnableVertexAttribArray(0);
-    GLint a_Position = glGetAttribLocation(program.Program, "a_Position");
-    glVertexAttribPointer(a_Position, 2, GL_FLOAT, GL_FALSE, sizeof(OGLCUSTOMVERTEX), &(defaultVertices[0].position));
-
-    glEnableVertexAttribArray(1);
-    GLint a_TexCoord = glGetAttribLocation(program.Program, "a_TexCoord");
-    glVertexAttribPointer(a_TexCoord, 2, GL_FLOAT, GL_FALSE, sizeof(OGLCUSTOMVERTEX), &(defaultVertices[0].tu));
-
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-
-    glUseProgram(0); // disable shader
+    // Transformed quad is queued, and drawn along with the others sharing the texture
+    const ShaderProgram *program;
+    if (myIsYUV)
+        program = yuvInstancedProgram.Program ? &yuvInstancedProgram : &yuvProgram;
+    else
+        program = instancedProgram.Program ? &instancedProgram : &defaultProgram;
+    if (myRegion)
+        GetSpriteBatch()->Add(program, myRegion->Texture, filter, world, myRegion->UV, rgba);
+    else
+        GetSpriteBatch()->Add(program, myStream ? myStream->GetTexture() : myTexture, filter, world, OGLTEXRECT(), rgba);
+    return true;
 }
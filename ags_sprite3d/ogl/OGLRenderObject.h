@@ -1,9 +1,14 @@
 #ifndef SPRITE3D_OGLRENDEROBJECT_H
 #define SPRITE3D_OGLRENDEROBJECT_H
 
+#include <memory>
+#include <string>
 #include "RenderObject.h"
 #include "MathHelper.h"
 #include "OGLHelper.h"
+#include "OGLStreamingTexture.h"
+
+struct AtlasRegion;
 
 class OGLRenderObject : public RenderObject
 {
@@ -12,26 +17,54 @@ public:
     ~OGLRenderObject() override;
 
     void CreateTexture(int sprite_id, int bkg_num, const char *file) override;
+    void CreateTexture(const char *file, const std::vector<unsigned char> &data, const ImageInfo &info) override;
     void CreateTexture(const unsigned char* data, int width, int height, int bpp) override;
-    void Render(const Point &pos, const PointF &scaling, float rotation, const PointF &anchorPos,
+    void CreateYUVTexture(const unsigned char* data, int width, int height) override;
+    bool Render(const Point &pos, const PointF &scaling, float rotation, const PointF &anchorPos,
         const RGBA &rgba, int filtering) override;
 
     int GetTexWidth() override { return myTexWidth; }
     int GetTexHeight() override { return myTexHeight; }
     bool GetHasAlpha() override { return myHasAlpha; }
 
+    size_t GetMemorySize() override;
+    void Evict() override;
+    int GetSourceRoom() override { return mySourceRoom; }
+
     static bool CreateStaticData();
+    static void DestroyStaticData();
+    static bool IsYUVSupported() { return yuvProgram.Program != 0; }
 
 private:
+    // Creates texture from the source given to CreateTexture
+    void LoadTexture();
+    void CreateImageTexture(const unsigned char *data, const ImageInfo &info);
+    void ReleaseTexture();
+    // Engine sprites are not evicted: dynamic ones may be deleted or drawn on
+    // meanwhile, and reading them again would show some other image
+    bool CanEvict() const { return myBackground >= 0 || !myFile.empty(); }
+
     unsigned myTexture = 0u;
+    AtlasRegion *myRegion = nullptr; // set instead of texture when packed into atlas
+    std::unique_ptr<OGLStreamingTexture> myStream; // set instead of texture for video
     int myWidth = 0;
     int myHeight = 0;
     int myTexWidth = 0;
     int myTexHeight = 0;
     bool myHasAlpha = false;
+    bool myIsYUV = false;
+
+    // Source of the texture, to create it again after eviction
+    int mySpriteID = -1;
+    int myBackground = -1;
+    std::string myFile;
+    int mySourceRoom = -1;
+    bool myIsEvicted = false;
 
-    static OGLCUSTOMVERTEX defaultVertices[4];
     static ShaderProgram defaultProgram;
+    static ShaderProgram instancedProgram;
+    static ShaderProgram yuvProgram;
+    static ShaderProgram yuvInstancedProgram;
 };
 
 #endif // SPRITE3D_OGLRENDEROBJECT_H
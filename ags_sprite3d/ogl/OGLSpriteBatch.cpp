@@ -0,0 +1,254 @@
+#include "OGLSpriteBatch.h"
+#include <cstddef>
+#include <glad/glad.h>
+#include "Common.h"
+#include "BaseObject.h"
+#include "OGLFactory.h"
+#include "OGLState.h"
+
+
+// Unit quad, corners in the order of the index pattern below,
+// which is also the order of a triangle strip
+static const float QuadCorners[4][4] =
+{
+    // x, y, u, v
+    { 0.f, 0.f, 0.f, 0.f },
+    { 1.f, 0.f, 1.f, 0.f },
+    { 0.f, -1.f, 0.f, 1.f },
+    { 1.f, -1.f, 1.f, 1.f }
+};
+
+bool OGLSpriteBatch::IsInstancingSupported()
+{
+    return GLAD_GL_ARB_instanced_arrays && GLAD_GL_ARB_draw_instanced;
+}
+
+bool OGLSpriteBatch::Create()
+{
+    myInstances.reserve(MaxQuads);
+    myVertices.reserve(MaxQuads * 4);
+
+    glGenBuffers(1, &myVertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, myVertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, MaxQuads * 4 * sizeof(OGLBATCHVERTEX), nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Two triangles per quad, the pattern never changes
+    std::vector<GLushort> indices(MaxQuads * 6);
+    for (int i = 0; i < MaxQuads; ++i)
+    {
+        GLushort base = static_cast<GLushort>(i * 4);
+        indices[i * 6 + 0] = base + 0;
+        indices[i * 6 + 1] = base + 1;
+        indices[i * 6 + 2] = base + 2;
+        indices[i * 6 + 3] = base + 2;
+        indices[i * 6 + 4] = base + 1;
+        indices[i * 6 + 5] = base + 3;
+    }
+    glGenBuffers(1, &myIndexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myIndexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort), &indices[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    if (IsInstancingSupported())
+    {
+        float corners[4][2];
+        for (int i = 0; i < 4; ++i)
+        {
+            corners[i][0] = QuadCorners[i][0];
+            corners[i][1] = QuadCorners[i][1];
+        }
+        glGenBuffers(1, &myCornerBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, myCornerBuffer);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+        glGenBuffers(1, &myInstanceBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, myInstanceBuffer);
+        glBufferData(GL_ARRAY_BUFFER, MaxQuads * sizeof(OGLSPRITEINSTANCE), nullptr, GL_STREAM_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    if (GLAD_GL_ARB_vertex_array_object)
+        glGenVertexArrays(1, &myVertexArray);
+
+    return myVertexBuffer != 0 && myIndexBuffer != 0;
+}
+
+void OGLSpriteBatch::Destroy()
+{
+    GLuint buffers[] = { myVertexBuffer, myIndexBuffer, myCornerBuffer, myInstanceBuffer };
+    for (GLuint buffer : buffers)
+    {
+        if (buffer)
+            glDeleteBuffers(1, &buffer);
+    }
+    if (myVertexArray)
+        glDeleteVertexArrays(1, &myVertexArray);
+    myVertexBuffer = 0;
+    myIndexBuffer = 0;
+    myCornerBuffer = 0;
+    myInstanceBuffer = 0;
+    myVertexArray = 0;
+    myAttribProgram = nullptr;
+    myInstances.clear();
+}
+
+void OGLSpriteBatch::Add(const ShaderProgram *program, unsigned texture, int filter,
+    const Matrix &mvp, const OGLTEXRECT &uv, const RGBA &rgba)
+{
+    if (!myInstances.empty() &&
+        (program != myProgram || texture != myTexture || filter != myFilter ||
+         myInstances.size() >= MaxQuads))
+    {
+        Flush();
+    }
+    myProgram = program;
+    myTexture = texture;
+    myFilter = filter;
+
+    OGLSPRITEINSTANCE inst;
+    inst.transformX[0] = mvp._11; inst.transformX[1] = mvp._12; inst.transformX[2] = mvp._13; inst.transformX[3] = mvp._14;
+    inst.transformY[0] = mvp._21; inst.transformY[1] = mvp._22; inst.transformY[2] = mvp._23; inst.transformY[3] = mvp._24;
+    inst.transformW[0] = mvp._41; inst.transformW[1] = mvp._42; inst.transformW[2] = mvp._43; inst.transformW[3] = mvp._44;
+    inst.uv = uv;
+    inst.r = rgba.r;
+    inst.g = rgba.g;
+    inst.b = rgba.b;
+    inst.a = rgba.a;
+    myInstances.push_back(inst);
+}
+
+void OGLSpriteBatch::Flush()
+{
+    if (myInstances.empty())
+        return;
+
+    OGLState *state = GetGLState();
+    state->UseProgram(myProgram->Program);
+    state->SetTextureParams(myTexture, myFilter == BaseObject::FILTER_LINEAR ? GL_LINEAR : GL_NEAREST, GL_CLAMP);
+    state->BindTexture(myTexture);
+
+    if (myProgram->IsInstanced())
+        DrawInstanced();
+    else
+        DrawQuads();
+
+    myInstances.clear();
+}
+
+void OGLSpriteBatch::DrawInstanced()
+{
+    // Orphan the previous storage, so that we don't wait for the draws still using it
+    GetGLState()->BindArrayBuffer(myInstanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER, MaxQuads * sizeof(OGLSPRITEINSTANCE), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, myInstances.size() * sizeof(OGLSPRITEINSTANCE), &myInstances[0]);
+
+    SetupAttributes(*myProgram);
+    glDrawArraysInstancedARB(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(myInstances.size()));
+}
+
+void OGLSpriteBatch::DrawQuads()
+{
+    myVertices.resize(myInstances.size() * 4);
+    TransformUnitQuads(myInstances[0].transformX, sizeof(OGLSPRITEINSTANCE), myInstances.size(),
+        &myVertices[0].x, sizeof(OGLBATCHVERTEX));
+    for (size_t n = 0; n < myInstances.size(); ++n)
+    {
+        const OGLSPRITEINSTANCE &inst = myInstances[n];
+        for (int i = 0; i < 4; ++i)
+        {
+            OGLBATCHVERTEX &v = myVertices[n * 4 + i];
+            v.tu = inst.uv.u0 + (inst.uv.u1 - inst.uv.u0) * QuadCorners[i][2];
+            v.tv = inst.uv.v0 + (inst.uv.v1 - inst.uv.v0) * QuadCorners[i][3];
+            v.r = inst.r;
+            v.g = inst.g;
+            v.b = inst.b;
+            v.a = inst.a;
+        }
+    }
+
+    GetGLState()->BindArrayBuffer(myVertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, MaxQuads * 4 * sizeof(OGLBATCHVERTEX), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, myVertices.size() * sizeof(OGLBATCHVERTEX), &myVertices[0]);
+
+    SetupAttributes(*myProgram);
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(myInstances.size() * 6), GL_UNSIGNED_SHORT, nullptr);
+}
+
+void OGLSpriteBatch::ReleaseTexture(unsigned texture)
+{
+    if (!myInstances.empty() && myTexture == texture)
+        Flush();
+}
+
+// Sets up float attribute, skipped if the shader does not have it
+static void SetAttribute(GLint location, GLint size, GLsizei stride, size_t offset, GLuint divisor)
+{
+    if (location < 0)
+        return;
+    glEnableVertexAttribArray(location);
+    glVertexAttribPointer(location, size, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const void*>(offset));
+    if (OGLSpriteBatch::IsInstancingSupported())
+        glVertexAttribDivisorARB(location, divisor);
+}
+
+void OGLSpriteBatch::SetupAttributes(const ShaderProgram &program)
+{
+    if (myVertexArray)
+        GetGLState()->BindVertexArray(myVertexArray);
+    if (myAttribProgram == &program)
+        return;
+    if (myAttribProgram)
+        DisableAttributes(*myAttribProgram);
+
+    OGLState *state = GetGLState();
+    if (program.IsInstanced())
+    {
+        const GLsizei stride = sizeof(OGLSPRITEINSTANCE);
+        state->BindArrayBuffer(myCornerBuffer);
+        SetAttribute(program.PositionAttr, 2, 2 * sizeof(float), 0, 0);
+        state->BindArrayBuffer(myInstanceBuffer);
+        SetAttribute(program.TransformAttr[0], 4, stride, offsetof(OGLSPRITEINSTANCE, transformX), 1);
+        SetAttribute(program.TransformAttr[1], 4, stride, offsetof(OGLSPRITEINSTANCE, transformY), 1);
+        SetAttribute(program.TransformAttr[2], 4, stride, offsetof(OGLSPRITEINSTANCE, transformW), 1);
+        SetAttribute(program.TexRectAttr, 4, stride, offsetof(OGLSPRITEINSTANCE, uv), 1);
+        SetAttribute(program.ColorAttr, 4, stride, offsetof(OGLSPRITEINSTANCE, r), 1);
+    }
+    else
+    {
+        const GLsizei stride = sizeof(OGLBATCHVERTEX);
+        state->BindArrayBuffer(myVertexBuffer);
+        SetAttribute(program.PositionAttr, 4, stride, offsetof(OGLBATCHVERTEX, x), 0);
+        SetAttribute(program.TexCoordAttr, 2, stride, offsetof(OGLBATCHVERTEX, tu), 0);
+        SetAttribute(program.ColorAttr, 4, stride, offsetof(OGLBATCHVERTEX, r), 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myIndexBuffer);
+    }
+    myAttribProgram = &program;
+}
+
+void OGLSpriteBatch::DisableAttributes(const ShaderProgram &program)
+{
+    const GLint attribs[] = { program.PositionAttr, program.TexCoordAttr, program.ColorAttr,
+        program.TransformAttr[0], program.TransformAttr[1], program.TransformAttr[2], program.TexRectAttr };
+    for (GLint location : attribs)
+    {
+        if (location < 0)
+            continue;
+        glDisableVertexAttribArray(location);
+        if (IsInstancingSupported())
+            glVertexAttribDivisorARB(location, 0);
+    }
+}
+
+void OGLSpriteBatch::EndStage()
+{
+    Flush();
+
+    // Vertex array object keeps our setup to itself, otherwise undo it
+    if (!myVertexArray && myAttribProgram)
+    {
+        DisableAttributes(*myAttribProgram);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        myAttribProgram = nullptr;
+    }
+    GetGLState()->Restore();
+}
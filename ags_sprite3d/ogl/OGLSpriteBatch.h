@@ -0,0 +1,56 @@
+#ifndef SPRITE3D_OGLSPRITEBATCH_H
+#define SPRITE3D_OGLSPRITEBATCH_H
+
+#include <vector>
+#include "MathHelper.h"
+#include "OGLHelper.h"
+
+// Collects sprites and draws each run of them sharing texture, shader and
+// filter at once. With an instanced shader every sprite is passed as one
+// instance of the unit quad; otherwise sprites are expanded into quads
+// in a streaming vertex buffer.
+class OGLSpriteBatch
+{
+public:
+    // Tells if the context can draw instanced shaders
+    static bool IsInstancingSupported();
+
+    bool Create();
+    void Destroy();
+
+    // Queues a unit quad transformed by the full world-view-projection matrix
+    void Add(const ShaderProgram *program, unsigned texture, int filter,
+        const Matrix &mvp, const OGLTEXRECT &uv, const RGBA &rgba);
+    // Draws all the queued quads
+    void Flush();
+    // Draws queued quads if any of them refer to this texture
+    void ReleaseTexture(unsigned texture);
+    // Flushes and resets GL state which the engine may not expect us to change
+    void EndStage();
+
+private:
+    // Points shader attributes at the vertex buffers, unless already done
+    void SetupAttributes(const ShaderProgram &program);
+    void DisableAttributes(const ShaderProgram &program);
+    void DrawInstanced();
+    void DrawQuads();
+
+    static const int MaxQuads = 4096;
+
+    std::vector<OGLSPRITEINSTANCE> myInstances;
+    std::vector<OGLBATCHVERTEX> myVertices;
+    const ShaderProgram *myProgram = nullptr;
+    unsigned myTexture = 0u;
+    int myFilter = 0;
+
+    GLuint myVertexBuffer = 0;
+    GLuint myIndexBuffer = 0;
+    GLuint myCornerBuffer = 0;
+    GLuint myInstanceBuffer = 0;
+    // Keeps attribute setup between flushes, if supported
+    GLuint myVertexArray = 0;
+    // Program which attributes are currently set up for
+    const ShaderProgram *myAttribProgram = nullptr;
+};
+
+#endif // SPRITE3D_OGLSPRITEBATCH_H
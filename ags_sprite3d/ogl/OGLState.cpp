@@ -0,0 +1,91 @@
+#include "OGLState.h"
+
+
+void OGLState::UseProgram(GLuint program)
+{
+    if (myProgram == program)
+        return;
+    glUseProgram(program);
+    myProgram = program;
+}
+
+void OGLState::BindTexture(GLuint texture)
+{
+    if (myActiveTexture != GL_TEXTURE0)
+    {
+        glActiveTexture(GL_TEXTURE0);
+        myActiveTexture = GL_TEXTURE0;
+    }
+    if (myTexture == texture)
+        return;
+    glBindTexture(GL_TEXTURE_2D, texture);
+    myTexture = texture;
+}
+
+void OGLState::BindVertexArray(GLuint vertexArray)
+{
+    if (myVertexArray == vertexArray)
+        return;
+    glBindVertexArray(vertexArray);
+    myVertexArray = vertexArray;
+}
+
+void OGLState::BindArrayBuffer(GLuint buffer)
+{
+    if (myArrayBuffer == buffer)
+        return;
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    myArrayBuffer = buffer;
+}
+
+void OGLState::SetTextureParams(GLuint texture, GLint filter, GLint wrap)
+{
+    auto it = myTextures.find(texture);
+    bool setFilter = it == myTextures.end() || it->second.Filter != filter;
+    bool setWrap = it == myTextures.end() || it->second.Wrap != wrap;
+    if (!setFilter && !setWrap)
+        return;
+
+    BindTexture(texture);
+    if (setFilter)
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    }
+    if (setWrap)
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+    }
+    myTextures[texture] = TextureParams{ filter, wrap };
+}
+
+void OGLState::DeleteTexture(GLuint texture)
+{
+    if (!texture)
+        return;
+    glDeleteTextures(1, &texture);
+    // Names get reused, forget everything about this one
+    myTextures.erase(texture);
+    if (myTexture == texture)
+        myTexture = 0;
+}
+
+void OGLState::Restore()
+{
+    if (GLAD_GL_ARB_vertex_array_object)
+        BindVertexArray(0);
+    BindArrayBuffer(0);
+    BindTexture(0);
+    UseProgram(0);
+    Forget();
+}
+
+void OGLState::Forget()
+{
+    myProgram = Unknown;
+    myTexture = Unknown;
+    myVertexArray = Unknown;
+    myArrayBuffer = Unknown;
+    myActiveTexture = 0;
+}
@@ -0,0 +1,46 @@
+#ifndef SPRITE3D_OGLSTATE_H
+#define SPRITE3D_OGLSTATE_H
+
+#include <unordered_map>
+#include <glad/glad.h>
+
+// Shadows the GL bindings we use, so that repeated binds of the same
+// object are skipped, and remembers sampler parameters of each texture.
+// Bindings are only trusted between our own calls; the engine may change
+// them at any time outside of the render stage, see Restore() and Forget().
+class OGLState
+{
+public:
+    void UseProgram(GLuint program);
+    // Binds 2D texture on the first texture unit
+    void BindTexture(GLuint texture);
+    void BindVertexArray(GLuint vertexArray);
+    void BindArrayBuffer(GLuint buffer);
+    // Sets filtering and wrapping of the texture, if they differ from the last ones set
+    void SetTextureParams(GLuint texture, GLint filter, GLint wrap);
+    void DeleteTexture(GLuint texture);
+
+    // Puts back the bindings engine may rely on, and forgets shadowed ones
+    void Restore();
+    // Forgets shadowed bindings without touching GL, for when the engine may
+    // have changed them since our last calls
+    void Forget();
+
+private:
+    static const GLuint Unknown = ~0u;
+
+    struct TextureParams
+    {
+        GLint Filter;
+        GLint Wrap;
+    };
+
+    GLuint myProgram = Unknown;
+    GLuint myTexture = Unknown;
+    GLuint myVertexArray = Unknown;
+    GLuint myArrayBuffer = Unknown;
+    GLenum myActiveTexture = 0;
+    std::unordered_map<GLuint, TextureParams> myTextures;
+};
+
+#endif // SPRITE3D_OGLSTATE_H
@@ -0,0 +1,175 @@
+#include "OGLStreamingTexture.h"
+#include <iterator>
+#include "Common.h"
+#include "OGLFactory.h"
+#include "OGLHelper.h"
+#include "OGLState.h"
+
+
+OGLStreamingTexture::~OGLStreamingTexture()
+{
+    Destroy();
+}
+
+bool OGLStreamingTexture::IsPixelBufferSupported()
+{
+#if AGS_OPENGL_ES2
+    return false;
+#else
+    return GLAD_GL_VERSION_2_1 != 0;
+#endif
+}
+
+bool OGLStreamingTexture::Create(int width, int height, int bpp, bool pixelBuffers)
+{
+    Destroy();
+    if (width <= 0 || height <= 0 || !GetPixelFormat(bpp, myFormat, myType))
+        return false;
+
+    myWidth = width;
+    myHeight = height;
+    myBPP = bpp;
+
+    glGenTextures(1, &myTexture);
+    GetGLState()->SetTextureParams(myTexture, GL_NEAREST, GL_CLAMP);
+    GetGLState()->BindTexture(myTexture);
+    // Storage is allocated once, frames only replace the contents
+    if (GLAD_GL_ARB_texture_storage)
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+    else
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, myFormat, myType, nullptr);
+    GetGLState()->BindTexture(0);
+
+    myHasBuffers = pixelBuffers;
+    if (myHasBuffers)
+    {
+        const GLsizeiptr size = width * height * bpp;
+        glGenBuffers(NumBuffers, myBuffers);
+        for (int i = 0; i < NumBuffers; ++i)
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, myBuffers[i]);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    DBGF("OGL: created streaming texture %d x %d, %d bytes per pixel", width, height, bpp);
+    return myTexture != 0;
+}
+
+void OGLStreamingTexture::Destroy()
+{
+    for (int i = 0; i < NumBuffers; ++i)
+    {
+        if (myFences[i])
+            glDeleteSync(myFences[i]);
+        myFences[i] = nullptr;
+    }
+    if (myBuffers[0])
+        glDeleteBuffers(NumBuffers, myBuffers);
+    for (int i = 0; i < NumBuffers; ++i)
+        myBuffers[i] = 0;
+    if (myTexture)
+        GetGLState()->DeleteTexture(myTexture);
+    myTexture = 0u;
+    myNextBuffer = 0;
+    myHasBuffers = false;
+}
+
+size_t OGLStreamingTexture::GetMemorySize() const
+{
+    if (!myTexture)
+        return 0;
+    return static_cast<size_t>(myWidth) * myHeight * (4 + (myHasBuffers ? NumBuffers * myBPP : 0));
+}
+
+bool OGLStreamingTexture::Update(const unsigned char *data)
+{
+    if (!myTexture)
+        return false;
+
+    if (!myHasBuffers)
+    {
+        GetGLState()->BindTexture(myTexture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, (myWidth * myBPP) % 4 == 0 ? 4 : 1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, myWidth, myHeight, myFormat, myType, data);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        GetGLState()->BindTexture(0);
+        return true;
+    }
+
+    const int index = myNextBuffer;
+    if (myFences[index])
+    {
+        // Never wait here: if GL still reads this buffer, skip the frame
+        if (glClientWaitSync(myFences[index], 0, 0) == GL_TIMEOUT_EXPIRED)
+            return false;
+        glDeleteSync(myFences[index]);
+        myFences[index] = nullptr;
+    }
+
+    const GLsizeiptr size = myWidth * myHeight * myBPP;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, myBuffers[index]);
+    // Without fences, let the driver give us fresh memory instead
+    if (!GLAD_GL_ARB_sync)
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, size, data);
+
+    // With a pixel buffer bound, data pointer is the offset in it
+    GetGLState()->BindTexture(myTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, (myWidth * myBPP) % 4 == 0 ? 4 : 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, myWidth, myHeight, myFormat, myType, nullptr);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    GetGLState()->BindTexture(0);
+    // Engine uploads must not read from our buffer
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if (GLAD_GL_ARB_sync)
+        myFences[index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    myNextBuffer = (index + 1) % NumBuffers;
+    return true;
+}
+
+std::unique_ptr<OGLStreamingTexture> OGLStreamingTexturePool::Acquire(int width, int height, int bpp)
+{
+    // Most recently released first, its buffers are the most likely to be idle
+    for (auto it = myIdle.rbegin(); it != myIdle.rend(); ++it)
+    {
+        OGLStreamingTexture *texture = *it;
+        if (texture->GetWidth() == width && texture->GetHeight() == height && texture->GetBPP() == bpp)
+        {
+            myIdle.erase(std::next(it).base());
+            myIdleMemory -= texture->GetMemorySize();
+            return std::unique_ptr<OGLStreamingTexture>(texture);
+        }
+    }
+
+    std::unique_ptr<OGLStreamingTexture> texture(new OGLStreamingTexture());
+    if (!texture->Create(width, height, bpp, OGLStreamingTexture::IsPixelBufferSupported()))
+        return nullptr;
+    return texture;
+}
+
+void OGLStreamingTexturePool::Release(std::unique_ptr<OGLStreamingTexture> texture)
+{
+    if (!texture || !texture->GetTexture())
+        return;
+
+    myIdleMemory += texture->GetMemorySize();
+    myIdle.push_back(texture.release());
+    while (myIdleMemory > MaxIdleMemory)
+    {
+        OGLStreamingTexture *oldest = myIdle.front();
+        myIdle.erase(myIdle.begin());
+        myIdleMemory -= oldest->GetMemorySize();
+        delete oldest;
+    }
+}
+
+void OGLStreamingTexturePool::Clear()
+{
+    for (OGLStreamingTexture *texture : myIdle)
+        delete texture;
+    myIdle.clear();
+    myIdleMemory = 0;
+}
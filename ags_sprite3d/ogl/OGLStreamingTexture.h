@@ -0,0 +1,71 @@
+#ifndef SPRITE3D_OGLSTREAMINGTEXTURE_H
+#define SPRITE3D_OGLSTREAMINGTEXTURE_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <glad/glad.h>
+
+// Texture which contents are replaced every frame, such as video.
+// Frames are written into a ring of pixel buffers, from which GL copies
+// them to the texture asynchronously; a buffer is only written again
+// once the copy from it has completed. Without pixel buffer support
+// frames are uploaded straight from the client memory.
+class OGLStreamingTexture
+{
+public:
+    OGLStreamingTexture() = default;
+    ~OGLStreamingTexture();
+
+    // Pixel buffers need GL 2.1, and are not available in ES2
+    static bool IsPixelBufferSupported();
+
+    bool Create(int width, int height, int bpp, bool pixelBuffers);
+    void Destroy();
+    // Queues the new frame; returns false if it had to be skipped,
+    // because all the buffers are still in use
+    bool Update(const unsigned char *data);
+
+    unsigned GetTexture() const { return myTexture; }
+    int GetWidth() const { return myWidth; }
+    int GetHeight() const { return myHeight; }
+    int GetBPP() const { return myBPP; }
+    // Video and pixel buffer memory taken
+    size_t GetMemorySize() const;
+
+private:
+    static const int NumBuffers = 3;
+
+    unsigned myTexture = 0u;
+    GLuint myBuffers[NumBuffers] = {};
+    GLsync myFences[NumBuffers] = {};
+    bool myHasBuffers = false;
+    int myNextBuffer = 0;
+    int myWidth = 0;
+    int myHeight = 0;
+    int myBPP = 0;
+    GLenum myFormat = 0;
+    GLenum myType = 0;
+};
+
+// Keeps streaming textures no longer used, so that the next video of the
+// same size and format takes over their storage instead of allocating anew
+class OGLStreamingTexturePool
+{
+public:
+    // Returns a pooled texture if there is a matching one, or a new one
+    std::unique_ptr<OGLStreamingTexture> Acquire(int width, int height, int bpp);
+    // Keeps texture for reuse; the oldest are destroyed when over the memory limit
+    void Release(std::unique_ptr<OGLStreamingTexture> texture);
+    void Clear();
+
+private:
+    static const size_t MaxIdleMemory = 64 * 1024 * 1024;
+
+    // Not owned by smart pointers, as they must not be destroyed
+    // after the GL context at the program exit
+    std::vector<OGLStreamingTexture*> myIdle; // oldest first
+    size_t myIdleMemory = 0;
+};
+
+#endif // SPRITE3D_OGLSTREAMINGTEXTURE_H
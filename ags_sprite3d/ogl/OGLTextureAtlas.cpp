@@ -0,0 +1,290 @@
+#include "OGLTextureAtlas.h"
+#include <algorithm>
+#include <glad/glad.h>
+#include "Common.h"
+#include "OGLFactory.h"
+#include "OGLSpriteBatch.h"
+#include "OGLState.h"
+
+
+void OGLTextureAtlas::Destroy()
+{
+    for (auto &page : myPages)
+    {
+        GetGLState()->DeleteTexture(page->Texture);
+        for (auto &region : page->Regions)
+        {
+            region->Texture = 0u;
+            myOrphans.push_back(std::move(region));
+        }
+    }
+    myPages.clear();
+}
+
+AtlasRegion *OGLTextureAtlas::Add(const unsigned char* const* rows, int width, int height)
+{
+    if (width <= 0 || height <= 0 || width > MaxImageSize || height > MaxImageSize)
+        return nullptr;
+
+    const int slotWidth = width + Padding * 2;
+    const int slotHeight = height + Padding * 2;
+    int x, y;
+    Page *page = nullptr;
+    for (auto &p : myPages)
+    {
+        if (Pack(p->Skyline, slotWidth, slotHeight, x, y))
+        {
+            page = p.get();
+            break;
+        }
+    }
+
+    if (!page)
+    {
+        std::unique_ptr<Page> newPage(new Page());
+        if (!CreatePage(*newPage) || !Pack(newPage->Skyline, slotWidth, slotHeight, x, y))
+        {
+            if (newPage->Texture)
+                GetGLState()->DeleteTexture(newPage->Texture);
+            return nullptr;
+        }
+        page = newPage.get();
+        myPages.push_back(std::move(newPage));
+    }
+
+    std::unique_ptr<AtlasRegion> region(new AtlasRegion());
+    region->Width = width;
+    region->Height = height;
+    SetRegion(*region, page->Texture, x + Padding, y + Padding);
+    Upload(*region, rows);
+
+    page->UsedArea += slotWidth * slotHeight;
+    page->PackedArea += slotWidth * slotHeight;
+    page->Regions.push_back(std::move(region));
+    return page->Regions.back().get();
+}
+
+void OGLTextureAtlas::Release(AtlasRegion *region)
+{
+    if (!region->Texture)
+    {
+        myOrphans.erase(std::remove_if(myOrphans.begin(), myOrphans.end(),
+            [region](const std::unique_ptr<AtlasRegion> &r) { return r.get() == region; }), myOrphans.end());
+        return;
+    }
+
+    auto pageIt = std::find_if(myPages.begin(), myPages.end(),
+        [region](const std::unique_ptr<Page> &p) { return p->Texture == region->Texture; });
+    if (pageIt == myPages.end())
+        return;
+
+    Page &page = **pageIt;
+    auto regionIt = std::find_if(page.Regions.begin(), page.Regions.end(),
+        [region](const std::unique_ptr<AtlasRegion> &r) { return r.get() == region; });
+    if (regionIt == page.Regions.end())
+        return;
+
+    page.UsedArea -= (region->Width + Padding * 2) * (region->Height + Padding * 2);
+    page.Regions.erase(regionIt);
+
+    if (page.Regions.empty())
+    {
+        // Drop empty pages
+        GetSpriteBatch()->ReleaseTexture(page.Texture);
+        GetGLState()->DeleteTexture(page.Texture);
+        myPages.erase(pageIt);
+    }
+    else if (page.PackedArea > myPageSize * myPageSize / 2 && page.UsedArea * 4 < page.PackedArea)
+    {
+        // Most of what was packed here is released, reclaim the space
+        Repack(page);
+    }
+}
+
+bool OGLTextureAtlas::CreatePage(Page &page)
+{
+    if (myPageSize == 0)
+    {
+        GLint maxSize = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+        myPageSize = std::min(2048, static_cast<int>(maxSize));
+    }
+
+    glGenTextures(1, &page.Texture);
+    GetGLState()->SetTextureParams(page.Texture, GL_NEAREST, GL_CLAMP);
+    GetGLState()->BindTexture(page.Texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, myPageSize, myPageSize, 0, GL_BGRA, GL_UNSIGNED_BYTE, nullptr);
+    GetGLState()->BindTexture(0);
+
+    page.Skyline.assign(1, SkylineNode{ 0, 0, myPageSize });
+    DBGF("OGL: created atlas page %d x %d", myPageSize, myPageSize);
+    return page.Texture != 0;
+}
+
+// Skyline bottom-left packing: finds the lowest place along the skyline
+// where the rectangle fits, then raises the skyline over it
+bool OGLTextureAtlas::Pack(std::vector<SkylineNode> &skyline, int width, int height, int &outX, int &outY)
+{
+    int bestIndex = -1;
+    int bestTop = myPageSize + 1;
+    int bestWidth = myPageSize + 1;
+    for (size_t i = 0; i < skyline.size(); ++i)
+    {
+        int x = skyline[i].X;
+        if (x + width > myPageSize)
+            break;
+        // Rectangle rests on the highest node it spans
+        int y = 0;
+        int spanLeft = width;
+        for (size_t j = i; spanLeft > 0; ++j)
+        {
+            y = std::max(y, skyline[j].Y);
+            spanLeft -= skyline[j].Width;
+        }
+        if (y + height > myPageSize)
+            continue;
+        if (y + height < bestTop || (y + height == bestTop && skyline[i].Width < bestWidth))
+        {
+            bestIndex = static_cast<int>(i);
+            bestTop = y + height;
+            bestWidth = skyline[i].Width;
+            outX = x;
+            outY = y;
+        }
+    }
+    if (bestIndex < 0)
+        return false;
+
+    skyline.insert(skyline.begin() + bestIndex, SkylineNode{ outX, outY + height, width });
+    // Cut off the nodes now covered by the new one
+    for (size_t i = bestIndex + 1; i < skyline.size(); )
+    {
+        int overlap = skyline[i - 1].X + skyline[i - 1].Width - skyline[i].X;
+        if (overlap <= 0)
+            break;
+        if (overlap < skyline[i].Width)
+        {
+            skyline[i].X += overlap;
+            skyline[i].Width -= overlap;
+            break;
+        }
+        skyline.erase(skyline.begin() + i);
+    }
+    // Merge neighbours of equal height
+    for (size_t i = 0; i + 1 < skyline.size(); )
+    {
+        if (skyline[i].Y == skyline[i + 1].Y)
+        {
+            skyline[i].Width += skyline[i + 1].Width;
+            skyline.erase(skyline.begin() + i + 1);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    return true;
+}
+
+void OGLTextureAtlas::SetRegion(AtlasRegion &region, unsigned texture, int x, int y)
+{
+    region.Texture = texture;
+    region.X = x;
+    region.Y = y;
+    region.UV.u0 = static_cast<float>(x) / myPageSize;
+    region.UV.v0 = static_cast<float>(y) / myPageSize;
+    region.UV.u1 = static_cast<float>(x + region.Width) / myPageSize;
+    region.UV.v1 = static_cast<float>(y + region.Height) / myPageSize;
+}
+
+void OGLTextureAtlas::Upload(const AtlasRegion &region, const unsigned char* const* rows)
+{
+    const int bpp = 4;
+    const int w = region.Width;
+    const int h = region.Height;
+    const int slotWidth = w + Padding * 2;
+    const int slotHeight = h + Padding * 2;
+
+    // Copy the image with its edges repeated over the padding
+    unsigned char *staging = GetStagingBuffer(slotWidth * slotHeight * bpp);
+    for (int y = 0; y < slotHeight; ++y)
+    {
+        const unsigned char *src = rows[std::min(std::max(y - Padding, 0), h - 1)];
+        unsigned char *dst = staging + y * slotWidth * bpp;
+        for (int x = 0; x < Padding; ++x)
+            memcpy(dst + x * bpp, src, bpp);
+        memcpy(dst + Padding * bpp, src, w * bpp);
+        for (int x = Padding + w; x < slotWidth; ++x)
+            memcpy(dst + x * bpp, src + (w - 1) * bpp, bpp);
+    }
+
+    GetGLState()->BindTexture(region.Texture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, region.X - Padding, region.Y - Padding, slotWidth, slotHeight,
+        GL_BGRA, GL_UNSIGNED_BYTE, staging);
+    GetGLState()->BindTexture(0);
+    ReleaseStagingBuffer();
+}
+
+// Packs the live images anew, tallest first, and moves them to a new texture
+void OGLTextureAtlas::Repack(Page &page)
+{
+    if (!GLAD_GL_EXT_framebuffer_object)
+        return; // no way to copy texture data on GPU
+
+    std::vector<AtlasRegion*> regions;
+    for (auto &r : page.Regions)
+        regions.push_back(r.get());
+    std::sort(regions.begin(), regions.end(),
+        [](const AtlasRegion *a, const AtlasRegion *b) { return a->Height > b->Height; });
+
+    Page newPage;
+    newPage.Skyline.assign(1, SkylineNode{ 0, 0, myPageSize });
+    std::vector<std::pair<int, int>> places(regions.size());
+    for (size_t i = 0; i < regions.size(); ++i)
+    {
+        if (!Pack(newPage.Skyline, regions[i]->Width + Padding * 2, regions[i]->Height + Padding * 2,
+                places[i].first, places[i].second))
+            return; // keep the old page as is
+    }
+    std::vector<SkylineNode> skyline;
+    skyline.swap(newPage.Skyline);
+    if (!CreatePage(newPage))
+        return;
+
+    // Copy the regions through the framebuffer, which has the old page attached
+    GLint prevFramebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING_EXT, &prevFramebuffer);
+    GLuint framebuffer = 0;
+    glGenFramebuffersEXT(1, &framebuffer);
+    glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, framebuffer);
+    glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D, page.Texture, 0);
+    bool complete = glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT) == GL_FRAMEBUFFER_COMPLETE_EXT;
+    if (complete)
+    {
+        GetGLState()->BindTexture(newPage.Texture);
+        for (size_t i = 0; i < regions.size(); ++i)
+        {
+            glCopyTexSubImage2D(GL_TEXTURE_2D, 0, places[i].first, places[i].second,
+                regions[i]->X - Padding, regions[i]->Y - Padding,
+                regions[i]->Width + Padding * 2, regions[i]->Height + Padding * 2);
+        }
+        GetGLState()->BindTexture(0);
+    }
+    glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, prevFramebuffer);
+    glDeleteFramebuffersEXT(1, &framebuffer);
+
+    if (!complete)
+    {
+        GetGLState()->DeleteTexture(newPage.Texture);
+        return;
+    }
+
+    GetSpriteBatch()->ReleaseTexture(page.Texture);
+    GetGLState()->DeleteTexture(page.Texture);
+    page.Texture = newPage.Texture;
+    page.Skyline.swap(skyline);
+    page.PackedArea = page.UsedArea;
+    for (size_t i = 0; i < regions.size(); ++i)
+        SetRegion(*regions[i], page.Texture, places[i].first + Padding, places[i].second + Padding);
+    DBGF("OGL: repacked atlas page, %d images", static_cast<int>(regions.size()));
+}
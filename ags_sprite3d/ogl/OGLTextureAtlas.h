@@ -0,0 +1,66 @@
+#ifndef SPRITE3D_OGLTEXTUREATLAS_H
+#define SPRITE3D_OGLTEXTUREATLAS_H
+
+#include <memory>
+#include <vector>
+#include "OGLHelper.h"
+
+// Location of a packed image; atlas may move it when repacking a page,
+// so users must read it each time they draw
+struct AtlasRegion
+{
+    unsigned Texture = 0u; // page texture
+    int X = 0;             // image position on the page, excluding padding
+    int Y = 0;
+    int Width = 0;
+    int Height = 0;
+    OGLTEXRECT UV;
+};
+
+// Packs small images into shared large textures ("pages"),
+// so that sprites using them may be drawn in one batch.
+class OGLTextureAtlas
+{
+public:
+    // Images larger than this get their own textures
+    static const int MaxImageSize = 256;
+
+    // Packs 32-bit BGRA image given as row pointers; returns null if it did not fit
+    AtlasRegion *Add(const unsigned char* const* rows, int width, int height);
+    void Release(AtlasRegion *region);
+    // Deletes the pages; regions still held stay valid, with no texture,
+    // until released, as their owners may outlive the device
+    void Destroy();
+
+private:
+    // Empty border around each image, filled with its edge pixels,
+    // which prevents neighbours from bleeding in when filtering
+    static const int Padding = 2;
+
+    struct SkylineNode
+    {
+        int X, Y, Width;
+    };
+
+    struct Page
+    {
+        unsigned Texture = 0u;
+        std::vector<SkylineNode> Skyline;
+        std::vector<std::unique_ptr<AtlasRegion>> Regions;
+        int UsedArea = 0;   // area of the live images, including padding
+        int PackedArea = 0; // area taken from the skyline since the last repack
+    };
+
+    bool CreatePage(Page &page);
+    bool Pack(std::vector<SkylineNode> &skyline, int width, int height, int &x, int &y);
+    void SetRegion(AtlasRegion &region, unsigned texture, int x, int y);
+    void Upload(const AtlasRegion &region, const unsigned char* const* rows);
+    void Repack(Page &page);
+
+    std::vector<std::unique_ptr<Page>> myPages;
+    // Regions of the destroyed pages
+    std::vector<std::unique_ptr<AtlasRegion>> myOrphans;
+    int myPageSize = 0;
+};
+
+#endif // SPRITE3D_OGLTEXTUREATLAS_H
@@ -0,0 +1,118 @@
+// s3dtpack: packs image files into a texture container, see TextureContainer.h
+//
+// Usage: s3dtpack <container> <image>...
+//
+// Images are stored under the paths given, which should be relative to the
+// folder of the container, the same as the game opens them from.
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Common.h"
+#include "ImageHelper.h"
+#include "TextureContainer.h"
+
+using namespace ContainerFormat;
+
+struct PackedImage
+{
+    std::string name;
+    std::vector<unsigned char> data;
+    ImageInfo info;
+};
+
+static uint64_t Align( uint64_t offset )
+{
+    return ( offset + DataAlignment - 1 ) / DataAlignment * DataAlignment;
+}
+
+static void WritePadding( FILE* file, uint64_t& offset, uint64_t target )
+{
+    for ( ; offset < target; ++offset )
+    {
+        fputc( 0, file );
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    if ( argc < 3 )
+    {
+        fprintf( stderr, "Usage: %s <container> <image>...\n", argv[0] );
+        return 1;
+    }
+    debug = stderr;
+
+    std::vector<PackedImage> images;
+    for ( int n = 2; n < argc; ++n )
+    {
+        PackedImage image;
+        image.name = argv[n];
+        for ( char& c : image.name )
+        {
+            c = ( c == '\\' ) ? '/' : c;
+        }
+        if ( !LoadImage( argv[n], image.data, image.info ) || image.info.BPP != 4 )
+        {
+            fprintf( stderr, "Could not load %s\n", argv[n] );
+            return 1;
+        }
+        images.push_back( std::move( image ) );
+    }
+
+    // Header, index, names, then the pixels
+    ContainerHeader header = {};
+    memcpy( header.magic, Magic, sizeof( Magic ) );
+    header.version = Version;
+    header.count = static_cast<uint32_t>( images.size() );
+    header.indexOffset = sizeof( header );
+
+    std::vector<ContainerEntry> entries( images.size() );
+    uint64_t offset = header.indexOffset + sizeof( ContainerEntry ) * entries.size();
+    for ( size_t n = 0; n < images.size(); ++n )
+    {
+        entries[n].nameOffset = static_cast<uint32_t>( offset );
+        offset += images[n].name.size() + 1;
+    }
+    for ( size_t n = 0; n < images.size(); ++n )
+    {
+        offset = Align( offset );
+        entries[n].dataOffset = offset;
+        entries[n].width = images[n].info.Width;
+        entries[n].height = images[n].info.Height;
+        entries[n].format = FORMAT_BGRA8;
+        entries[n].flags = images[n].info.HasAlpha ? FLAG_ALPHA : 0;
+        offset += images[n].data.size();
+    }
+
+    FILE* file = fopen( argv[1], "wb" );
+    if ( !file )
+    {
+        fprintf( stderr, "Could not write %s\n", argv[1] );
+        return 1;
+    }
+    fwrite( &header, sizeof( header ), 1, file );
+    fwrite( &entries[0], sizeof( ContainerEntry ), entries.size(), file );
+    offset = header.indexOffset + sizeof( ContainerEntry ) * entries.size();
+    for ( auto const& image : images )
+    {
+        fwrite( image.name.c_str(), image.name.size() + 1, 1, file );
+        offset += image.name.size() + 1;
+    }
+    for ( size_t n = 0; n < images.size(); ++n )
+    {
+        WritePadding( file, offset, entries[n].dataOffset );
+        fwrite( &images[n].data[0], images[n].data.size(), 1, file );
+        offset += images[n].data.size();
+    }
+    bool ok = !ferror( file );
+    fclose( file );
+    if ( !ok )
+    {
+        fprintf( stderr, "Could not write %s\n", argv[1] );
+        return 1;
+    }
+
+    printf( "Packed %u images into %s\n", header.count, argv[1] );
+    return 0;
+}